@@ -0,0 +1,61 @@
+#include "graph.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 1000000
+#define EDGES 4000000
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  int *src = (int *) malloc(EDGES * sizeof(int));
+  int *dst = (int *) malloc(EDGES * sizeof(int));
+  uint64_t seed = 19;
+  double t;
+
+  for (int i = 0; i < EDGES; ++i)
+  {
+    src[i] = gen_power_law(&seed, VERTICES);
+    dst[i] = (int) (bench_rand(&seed) % VERTICES);
+  }
+
+  // one edge at a time, deduplicated like read_graph
+  graph_t *g = create_graph("batch");
+
+  t = bench_now();
+  for (int i = 0; i < EDGES; ++i)
+  {
+    vertex_t *v1, *v2;
+
+    if (!(v1 = get_vertex_by_id(g, src[i])))
+      v1 = add_vertex(g, src[i], src[i]);
+    if (!(v2 = get_vertex_by_id(g, dst[i])))
+      v2 = add_vertex(g, dst[i], dst[i]);
+    if (!search_neighbourhood(v1, v2))
+      add_edge(v1, v2);
+    if (!search_neighbourhood(v2, v1))
+      add_edge(v2, v1);
+  }
+  bench_report("batch", "add_edge loop", EDGES, bench_now() - t);
+  destroy_graph(g);
+
+  g = create_graph("batch");
+  t = bench_now();
+  graph_add_edges(g, src, dst, EDGES, BATCH_UNDIRECTED);
+  bench_report("batch", "graph_add_edges", EDGES, bench_now() - t);
+  destroy_graph(g);
+
+  // the same batch split in chunks, as an ingestion pipeline would send it
+  g = create_graph("batch");
+  t = bench_now();
+  for (int i = 0; i < EDGES; i += EDGES / 8)
+    graph_add_edges(g, src + i, dst + i, EDGES / 8, BATCH_UNDIRECTED);
+  bench_report("batch", "graph_add_edges (8 chunks)", EDGES, bench_now() - t);
+  destroy_graph(g);
+
+  free(src);
+  free(dst);
+  return 0;
+}
@@ -0,0 +1,120 @@
+#ifndef __BENCH__
+#define __BENCH__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+/* ------------------------------------------------------------------------------
+ * function: bench_now
+ * ------------------------------------------------------------------------------
+ * returns: monotonic time in seconds
+ * ------------------------------------------------------------------------------ */
+
+static inline double bench_now (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: bench_rand
+ * ------------------------------------------------------------------------------
+ * xorshift64* generator, so the inputs are the same on every run
+ *
+ * state: generator state (must not be 0)
+ *
+ * returns: next pseudo random number
+ * ------------------------------------------------------------------------------ */
+
+static inline uint64_t bench_rand (uint64_t *state)
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+
+  return *state * 0x2545f4914f6cdd1dULL;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: bench_peak_rss
+ * ------------------------------------------------------------------------------
+ * returns: peak resident set size of the process so far, in KB
+ * ------------------------------------------------------------------------------ */
+
+static inline long bench_peak_rss (void)
+{
+  struct rusage usage;
+
+  return getrusage(RUSAGE_SELF, &usage) ? 0 : usage.ru_maxrss;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: bench_json
+ * ------------------------------------------------------------------------------
+ * returns: 1 if the results must be printed as json lines (environment
+ * variable BENCH_FORMAT=json, e.g. make bench BENCH_FORMAT=json) or 0 for the
+ * text table
+ * ------------------------------------------------------------------------------ */
+
+static inline int bench_json (void)
+{
+  const char *format = getenv("BENCH_FORMAT");
+
+  return format && !strcmp(format, "json");
+}
+
+/* ------------------------------------------------------------------------------
+ * function: bench_report
+ * ------------------------------------------------------------------------------
+ * prints one benchmark result
+ *
+ * bench: benchmark name
+ * name: measured case
+ * ops: number of operations done
+ * seconds: elapsed time
+ * ------------------------------------------------------------------------------ */
+
+static inline void bench_report (const char *bench, const char *name, long ops, double seconds)
+{
+  if (bench_json())
+    printf("{\"bench\": \"%s\", \"name\": \"%s\", \"ops\": %ld, \"seconds\": %.9f, "
+           "\"ops_per_sec\": %.1f, \"ns_per_op\": %.1f, \"peak_rss_kb\": %ld}\n", bench, name, ops,
+           seconds, seconds > 0 ? ops / seconds : 0.0, ops ? seconds * 1e9 / ops : 0.0, bench_peak_rss());
+  else
+    printf("%-12s %-28s %12ld ops %10.3f ms %10.1f ns/op\n", bench, name, ops,
+           seconds * 1e3, ops ? seconds * 1e9 / ops : 0.0);
+}
+
+/* ------------------------------------------------------------------------------
+ * function: bench_report_bytes
+ * ------------------------------------------------------------------------------
+ * prints one throughput result
+ *
+ * bench: benchmark name
+ * name: measured case
+ * bytes: number of bytes processed
+ * seconds: elapsed time
+ * ------------------------------------------------------------------------------ */
+
+static inline void bench_report_bytes (const char *bench, const char *name, long bytes, double seconds)
+{
+  if (bench_json())
+    printf("{\"bench\": \"%s\", \"name\": \"%s\", \"bytes\": %ld, \"seconds\": %.9f, "
+           "\"mb_per_sec\": %.1f, \"peak_rss_kb\": %ld}\n", bench, name, bytes, seconds,
+           seconds > 0 ? bytes / seconds / 1e6 : 0.0, bench_peak_rss());
+  else
+    printf("%-12s %-28s %12ld B   %10.3f ms %10.1f MB/s\n", bench, name, bytes,
+           seconds * 1e3, seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,56 @@
+#include "csr.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 500000
+#define EDGES 5000000
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  char text_path[] = "/tmp/queue-graph-XXXXXX", binary_path[] = "/tmp/queue-graph-XXXXXX";
+  int text_fd = mkstemp(text_path), binary_fd = mkstemp(binary_path);
+  FILE *text, *binary;
+  uint64_t seed = 5;
+  long sum = 0;
+  double t;
+
+  if (text_fd < 0 || binary_fd < 0 || !(text = fdopen(text_fd, "w+")) || !(binary = fdopen(binary_fd, "w")))
+  {
+    fprintf(stderr, "Error: unable to create file\n");
+    return 1;
+  }
+
+  for (int i = 0; i < EDGES; ++i)
+    fprintf(text, "%d %d\n", gen_power_law(&seed, VERTICES), (int) (bench_rand(&seed) % VERTICES));
+
+  rewind(text);
+  t = bench_now();
+  graph_t *g = read_graph("binary", text, 0);
+  bench_report("binary", "read_graph (text)", EDGES, bench_now() - t);
+
+  t = bench_now();
+  write_graph_binary(g, binary);
+  fclose(binary);
+  bench_report("binary", "write_graph_binary", EDGES, bench_now() - t);
+  destroy_graph(g);
+
+  t = bench_now();
+  csr_t *c = csr_map(binary_path);
+  bench_report("binary", "csr_map", EDGES, bench_now() - t);
+
+  // first pass faults the pages in
+  t = bench_now();
+  for (size_t i = 0; i < c->edges; ++i)
+    sum += c->targets[i];
+  bench_report("binary", "first scan (mapped)", c->edges, bench_now() - t);
+
+  csr_destroy(c);
+  fclose(text);
+  unlink(text_path);
+  unlink(binary_path);
+
+  return sum < 0;
+}
@@ -0,0 +1,167 @@
+#include "compact.h"
+#include "csr.h"
+#include "reorder.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 500000
+#define EDGES 4000000
+#define SIDE 1000
+#define ROUNDS 5
+
+/* ------------------------------------------------------------------------------ */
+
+// builds both snapshots of the graph, reports their size and how fast their
+// neighbours are read
+static int measure (graph_t *g, const char *order)
+{
+  long edges = 0, check = 0, sum = 0;
+  char label[64];
+  double t;
+  int j;
+
+  for (int i = 0; i < g->size; ++i)
+    edges += g->table[i]->degree;
+
+  t = bench_now();
+  csr_t *c = freeze_graph(g);
+  double frozen = bench_now() - t;
+
+  t = bench_now();
+  compact_t *z = compress_graph(g);
+  double compressed = bench_now() - t;
+
+  if (!c || !z)
+  {
+    csr_destroy(c);
+    compact_destroy(z);
+    return 0;
+  }
+
+  size_t list_bytes = edges * sizeof(edge_t);
+  size_t csr_bytes = c->edges * sizeof(int) + (c->size + 1) * sizeof(size_t);
+  size_t compact_bytes = z->bytes + (z->size + 1) * sizeof(uint32_t) +
+                         ((z->size >> COMPACT_BLOCK_BITS) + 1) * sizeof(size_t);
+
+  snprintf(label, sizeof(label), "%s, lists %.1f B/edge", order, (double) list_bytes / edges);
+  bench_report_bytes("compact", label, list_bytes, 0);
+  snprintf(label, sizeof(label), "%s, csr %.1f B/edge", order, (double) csr_bytes / edges);
+  bench_report_bytes("compact", label, csr_bytes, frozen);
+  snprintf(label, sizeof(label), "%s, compact %.2f B/edge", order, (double) compact_bytes / edges);
+  bench_report_bytes("compact", label, compact_bytes, compressed);
+
+  t = bench_now();
+  for (int r = 0; r < ROUNDS; ++r)
+    for (int i = 0; i < g->size; ++i)
+    {
+      edge_t *edge_it = g->table[i]->edges;
+
+      if (edge_it)
+        do
+          check += edge_it->vertex->index;
+        while ((edge_it = edge_it->next) != g->table[i]->edges);
+    }
+  snprintf(label, sizeof(label), "%s, walk edges lists", order);
+  bench_report("compact", label, ROUNDS * edges, bench_now() - t);
+
+  t = bench_now();
+  for (int r = 0; r < ROUNDS; ++r)
+    for (int i = 0; i < c->size; ++i)
+    {
+      csr_iter_t it = csr_iter(c, i);
+
+      while (csr_next(&it, &j))
+        sum += j;
+    }
+  snprintf(label, sizeof(label), "%s, walk csr", order);
+  bench_report("compact", label, ROUNDS * edges, bench_now() - t);
+
+  t = bench_now();
+  for (int r = 0; r < ROUNDS; ++r)
+    for (int i = 0; i < z->size; ++i)
+    {
+      compact_iter_t it = compact_iter(z, i);
+
+      while (compact_next(&it, &j))
+        sum -= j;
+    }
+  snprintf(label, sizeof(label), "%s, decode compact", order);
+  bench_report("compact", label, ROUNDS * edges, bench_now() - t);
+
+  csr_destroy(c);
+  compact_destroy(z);
+
+  // the same neighbours were read in the three walks
+  return sum == 0 && check >= 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  int *src = (int *) malloc(EDGES * sizeof(int));
+  int *dst = (int *) malloc(EDGES * sizeof(int));
+  graph_t *g = create_graph("compact");
+  uint64_t seed = 47;
+  int ok = 1;
+
+  if (!src || !dst || !g)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  for (int i = 0; i < EDGES; ++i)
+  {
+    src[i] = gen_power_law(&seed, VERTICES);
+    dst[i] = (int) (bench_rand(&seed) % VERTICES);
+  }
+
+  graph_add_edges(g, src, dst, EDGES, BATCH_UNDIRECTED);
+  free(src);
+  free(dst);
+
+  ok &= measure(g, "power law");
+  ok &= reorder_graph(g, REORDER_RCM) && measure(g, "power law, rcm");
+  destroy_graph(g);
+
+  // grid met in random order
+  long m = 2L * SIDE * (SIDE - 1);
+
+  g = create_graph("grid");
+  src = (int *) malloc(m * sizeof(int));
+  dst = (int *) malloc(m * sizeof(int));
+
+  if (!src || !dst || !g)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  gen_grid(SIDE, src, dst);
+
+  for (long i = m - 1; i > 0; --i)
+  {
+    long k = (long) (bench_rand(&seed) % (i + 1));
+    int a = src[i], b = dst[i];
+
+    src[i] = src[k];
+    dst[i] = dst[k];
+    src[k] = a;
+    dst[k] = b;
+  }
+
+  graph_add_edges(g, src, dst, m, BATCH_UNDIRECTED);
+  free(src);
+  free(dst);
+
+  ok &= measure(g, "grid");
+  ok &= reorder_graph(g, REORDER_RCM) && measure(g, "grid, rcm");
+  destroy_graph(g);
+
+  if (!ok)
+    fprintf(stderr, "Error: compact and csr neighbours differ\n");
+
+  return !ok;
+}
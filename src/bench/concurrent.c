@@ -0,0 +1,149 @@
+#include <pthread.h>
+
+#include "graph.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define IDS 200000
+#define OPS 1000000
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct worker_t
+{
+  pthread_t thread ;
+  graph_t *g ;
+  pthread_mutex_t *global ; // the old way: every call behind one mutex
+  uint64_t seed ;
+  long ops ;
+} worker_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+// writers and readers mixed: 50% add_edge, 20% remove_edge, 30% lookups
+static void *work (void *arg)
+{
+  worker_t *w = (worker_t *) arg;
+
+  for (long i = 0; i < w->ops; ++i)
+  {
+    int op = bench_rand(&w->seed) % 10;
+    int id1 = bench_rand(&w->seed) % IDS, id2 = bench_rand(&w->seed) % IDS;
+
+    if (w->global)
+      pthread_mutex_lock(w->global);
+
+    if (op < 5)
+      add_edge(find_or_add_vertex(w->g, id1, id1), find_or_add_vertex(w->g, id2, id2));
+    else
+    {
+      vertex_t *v1 = get_vertex_by_id(w->g, id1), *v2 = get_vertex_by_id(w->g, id2);
+
+      if (op < 7 && v1 && v2)
+        release_edge(w->g, remove_edge(v1, v2));
+      else if (v1 && v2)
+        search_neighbourhood(v1, v2);
+    }
+
+    if (w->global)
+      pthread_mutex_unlock(w->global);
+  }
+
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// checks the graph after the threads are done: the counters must match the
+// edges lists and every id must have a single vertex
+static int verify (graph_t *g)
+{
+  long edges = 0;
+  int *histogram = (int *) calloc(g->size + 1, sizeof(int));
+  int *stored = (int *) malloc((g->size + 1) * sizeof(int));
+  int ok = histogram && stored;
+
+  for (int i = 0; i < g->size && ok; ++i)
+  {
+    vertex_t *v = g->table[i];
+    edge_t *edge_it = v->edges;
+    int degree = 0;
+
+    if (edge_it)
+      do
+        degree++;
+      while ((edge_it = edge_it->next) != v->edges);
+
+    ok = degree == v->degree && get_vertex_by_id(g, v->id) == v && degree <= g->size;
+    edges += degree;
+    if (ok)
+      histogram[degree]++;
+  }
+
+  if (ok && (edge_count(g, 1) != edges || degree_histogram(g, stored, g->size + 1) > g->size + 1 ||
+             memcmp(histogram, stored, (g->size + 1) * sizeof(int))))
+    ok = 0;
+
+  free(histogram);
+  free(stored);
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int run (const char *name, int flags, int use_global, int threads)
+{
+  graph_t *g = create_graph_flags("concurrent", flags);
+  worker_t *workers = (worker_t *) malloc(threads * sizeof(worker_t));
+  pthread_mutex_t global = PTHREAD_MUTEX_INITIALIZER;
+  char label[64];
+  int started = 0, ok;
+  double t = bench_now();
+
+  for (int i = 0; i < threads; ++i)
+  {
+    workers[i].g = g;
+    workers[i].global = use_global ? &global : NULL;
+    workers[i].seed = 0x9e3779b97f4a7c15ULL * (i + 1);
+    workers[i].ops = OPS / threads;
+
+    if (!pthread_create(&(workers[i].thread), NULL, work, &workers[i]))
+      started++;
+    else
+      work(&workers[i]); // runs it here instead
+  }
+
+  for (int i = 0; i < started; ++i)
+    pthread_join(workers[i].thread, NULL);
+
+  snprintf(label, sizeof(label), "%s %d threads", name, threads);
+  bench_report("concurrent", label, (long) threads * (OPS / threads), bench_now() - t);
+
+  if (!(ok = verify(g)))
+    fprintf(stderr, "Error: %s left the graph inconsistent\n", label);
+
+  free(workers);
+  destroy_graph(g);
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (int argc, char **argv)
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+  int ok = 1;
+
+  if (max_threads < 4) // the stress test always runs with a few threads
+    max_threads = 4;
+
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+  {
+    ok &= run("global mutex", GRAPH_NO_POOL, 1, threads);
+    ok &= run("GRAPH_CONCURRENT", GRAPH_CONCURRENT, 0, threads);
+    ok &= run("with in-edges", GRAPH_CONCURRENT | GRAPH_IN_EDGES, 0, threads);
+  }
+
+  return !ok;
+}
@@ -0,0 +1,102 @@
+#include <math.h>
+
+#include "traversal.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+// road network sized grid: SIDE x SIDE vertices, 4 neighbours each
+#define SIDE 1000
+#define SOURCES 5
+
+/* ------------------------------------------------------------------------------ */
+
+// same as dijkstra, with the heap arity as a parameter
+static int arity_dijkstra (graph_t *g, vertex_t *source, double *dist, int arity)
+{
+  heap_t h;
+  double d;
+  int index, reached = 0;
+
+  heap_init(&h, g->size, arity);
+  for (int i = 0; i < g->size; ++i)
+    dist[i] = INFINITY;
+
+  dist[source->index] = 0.0;
+  heap_update(&h, source->index, 0.0);
+
+  while ((index = heap_pop(&h, &d)) >= 0)
+  {
+    vertex_t *v = g->table[index];
+    edge_t *edge_it = v->edges;
+
+    reached++;
+    if (edge_it)
+      do
+        if (d + edge_it->weight < dist[edge_it->vertex->index])
+        {
+          dist[edge_it->vertex->index] = d + edge_it->weight;
+          heap_update(&h, edge_it->vertex->index, d + edge_it->weight);
+        }
+      while ((edge_it = edge_it->next) != v->edges);
+  }
+
+  heap_destroy(&h);
+  return reached;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  graph_t *g = create_graph_flags("dijkstra", GRAPH_NO_EDGE_SET);
+  double *dist = (double *) malloc(SIDE * SIDE * sizeof(double));
+  uint64_t seed = 17;
+  long total = 0;
+  double t;
+
+  for (int i = 0; i < SIDE * SIDE; ++i)
+    add_vertex(g, i, i);
+
+  for (int y = 0; y < SIDE; ++y) // undirected, weights from 1 to 100
+    for (int x = 0; x < SIDE; ++x)
+    {
+      vertex_t *v = g->table[y * SIDE + x];
+
+      if (x + 1 < SIDE)
+      {
+        double w = 1 + bench_rand(&seed) % 100;
+
+        add_weighted_edge(v, g->table[y * SIDE + x + 1], w);
+        add_weighted_edge(g->table[y * SIDE + x + 1], v, w);
+      }
+
+      if (y + 1 < SIDE)
+      {
+        double w = 1 + bench_rand(&seed) % 100;
+
+        add_weighted_edge(v, g->table[(y + 1) * SIDE + x], w);
+        add_weighted_edge(g->table[(y + 1) * SIDE + x], v, w);
+      }
+    }
+
+  t = bench_now();
+  for (int i = 0; i < SOURCES; ++i)
+    total += dijkstra(g, g->table[(i * 7919) % g->size], dist, NULL);
+  bench_report("dijkstra", "dijkstra", (long) SOURCES * g->size, bench_now() - t);
+
+  for (int arity = 2; arity <= 8; arity *= 2)
+  {
+    char name[32];
+
+    snprintf(name, sizeof(name), "%d-ary heap", arity);
+    t = bench_now();
+    for (int i = 0; i < SOURCES; ++i)
+      total += arity_dijkstra(g, g->table[(i * 7919) % g->size], dist, arity);
+    bench_report("dijkstra", name, (long) SOURCES * g->size, bench_now() - t);
+  }
+
+  free(dist);
+  destroy_graph(g);
+  return total < 0;
+}
@@ -0,0 +1,73 @@
+#include "graph.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 50000
+#define EDGES 200000
+
+/* ------------------------------------------------------------------------------ */
+
+static void run (const char *name, int flags, int *src, int *dst)
+{
+  char label[64];
+  long found = 0;
+  double t;
+
+  graph_t *g = create_graph_flags("edges", flags);
+
+  // same deduplication done by read_graph for undirected graphs
+  t = bench_now();
+  for (int i = 0; i < EDGES; ++i)
+  {
+    vertex_t *v1, *v2;
+
+    if (!(v1 = get_vertex_by_id(g, src[i])))
+      v1 = add_vertex(g, src[i], src[i]);
+    if (!(v2 = get_vertex_by_id(g, dst[i])))
+      v2 = add_vertex(g, dst[i], dst[i]);
+    if (!search_neighbourhood(v1, v2))
+      add_edge(v1, v2);
+    if (!search_neighbourhood(v2, v1))
+      add_edge(v2, v1);
+  }
+  snprintf(label, sizeof(label), "%s load", name);
+  bench_report("edges", label, EDGES, bench_now() - t);
+
+  t = bench_now();
+  for (int i = 0; i < EDGES; ++i)
+    found += search_neighbourhood(get_vertex_by_id(g, dst[i]), get_vertex_by_id(g, src[EDGES - 1 - i]));
+  snprintf(label, sizeof(label), "%s search", name);
+  bench_report("edges", label, EDGES, bench_now() - t);
+
+  t = bench_now();
+  for (int i = 0; i < EDGES; i += 4)
+    release_edge(g, remove_edge(get_vertex_by_id(g, src[i]), get_vertex_by_id(g, dst[i])));
+  snprintf(label, sizeof(label), "%s remove", name);
+  bench_report("edges", label, EDGES / 4, bench_now() - t);
+
+  destroy_graph(g);
+  (void) found;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  int *src = (int *) malloc(EDGES * sizeof(int));
+  int *dst = (int *) malloc(EDGES * sizeof(int));
+  uint64_t seed = 7;
+
+  for (int i = 0; i < EDGES; ++i) // hubs on both ends
+  {
+    src[i] = gen_power_law(&seed, VERTICES);
+    dst[i] = gen_power_law(&seed, VERTICES);
+  }
+
+  run("edge set", 0, src, dst);
+  run("linear scan", GRAPH_NO_EDGE_SET, src, dst);
+
+  free(src);
+  free(dst);
+  return 0;
+}
@@ -0,0 +1,178 @@
+#ifndef __GEN__
+#define __GEN__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------
+ * function: gen_power_law
+ * ------------------------------------------------------------------------------
+ * picks a vertex with a skewed (power law like) distribution: the vertex k is
+ * chosen with probability proportional to k^(-2/3), so the first vertices
+ * become high degree hubs
+ *
+ * state: generator state
+ * n: number of vertices
+ *
+ * returns: vertex id from 0 to n - 1
+ * ------------------------------------------------------------------------------ */
+
+static inline int gen_power_law (uint64_t *state, int n)
+{
+  double u = (bench_rand(state) >> 11) * (1.0 / 9007199254740992.0);
+
+  return (int) (n * u * u * u);
+}
+
+/* ------------------------------------------------------------------------------
+ * function: gen_erdos_renyi
+ * ------------------------------------------------------------------------------
+ * generates an Erdos-Renyi G(n, m) graph: m edges with both endpoints picked
+ * uniformly at random (duplicates and self loops are left to the graph)
+ *
+ * state: generator state
+ * n: number of vertices
+ * m: number of edges
+ * src: source of each edge, room for m ids
+ * dst: destination of each edge, room for m ids
+ * ------------------------------------------------------------------------------ */
+
+static inline void gen_erdos_renyi (uint64_t *state, int n, long m, int *src, int *dst)
+{
+  for (long i = 0; i < m; ++i)
+  {
+    src[i] = (int) (bench_rand(state) % n);
+    dst[i] = (int) (bench_rand(state) % n);
+  }
+}
+
+/* ------------------------------------------------------------------------------
+ * function: gen_rmat
+ * ------------------------------------------------------------------------------
+ * generates an R-MAT graph on 2^scale vertices: every edge descends the
+ * adjacency matrix quadrant by quadrant with probabilities a = 0.57,
+ * b = c = 0.19 and d = 0.05, which gives a power law degree distribution and
+ * a community structure
+ *
+ * state: generator state
+ * scale: log2 of the number of vertices (at most 30)
+ * m: number of edges
+ * src: source of each edge, room for m ids
+ * dst: destination of each edge, room for m ids
+ * ------------------------------------------------------------------------------ */
+
+static inline void gen_rmat (uint64_t *state, int scale, long m, int *src, int *dst)
+{
+  for (long i = 0; i < m; ++i)
+  {
+    int u = 0, v = 0;
+
+    for (int bit = 0; bit < scale; ++bit)
+    {
+      uint64_t r = bench_rand(state) % 100;
+
+      u = u << 1 | (r >= 76); // c + d
+      v = v << 1 | (r >= 57 && r < 76) | (r >= 95); // b + d
+    }
+
+    src[i] = u;
+    dst[i] = v;
+  }
+}
+
+/* ------------------------------------------------------------------------------
+ * function: gen_grid
+ * ------------------------------------------------------------------------------
+ * generates a side x side grid where every vertex is joined to its right and
+ * bottom neighbours
+ *
+ * side: number of vertices on each side
+ * src: source of each edge, room for 2 * side * (side - 1) ids
+ * dst: destination of each edge, room for 2 * side * (side - 1) ids
+ *
+ * returns: number of edges
+ * ------------------------------------------------------------------------------ */
+
+static inline long gen_grid (int side, int *src, int *dst)
+{
+  long m = 0;
+
+  for (int row = 0; row < side; ++row)
+    for (int col = 0; col < side; ++col)
+    {
+      int v = row * side + col;
+
+      if (col + 1 < side)
+      {
+        src[m] = v;
+        dst[m++] = v + 1;
+      }
+
+      if (row + 1 < side)
+      {
+        src[m] = v;
+        dst[m++] = v + side;
+      }
+    }
+
+  return m;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: gen_petersen
+ * ------------------------------------------------------------------------------
+ * generates the generalized Petersen graph GP(n, k): an outer n-cycle, n
+ * spokes and an inner star polygon {n/k}, 3-regular for k < n / 2; GP(5, 2) is
+ * the Petersen graph of src/petersen
+ *
+ * n: number of outer vertices (the graph has 2n vertices)
+ * k: inner step, from 1 to n - 1
+ * src: source of each edge, room for 3n ids
+ * dst: destination of each edge, room for 3n ids
+ *
+ * returns: number of edges
+ * ------------------------------------------------------------------------------ */
+
+static inline long gen_petersen (int n, int k, int *src, int *dst)
+{
+  long m = 0;
+
+  for (int i = 0; i < n; ++i)
+  {
+    src[m] = i; // outer cycle
+    dst[m++] = (i + 1) % n;
+    src[m] = i; // spoke
+    dst[m++] = n + i;
+    src[m] = n + i; // inner star
+    dst[m++] = n + (i + k) % n;
+  }
+
+  return m;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: gen_write
+ * ------------------------------------------------------------------------------
+ * writes edges as an edge list readable by read_graph
+ *
+ * fp: output file
+ * m: number of edges
+ * src: source of each edge
+ * dst: destination of each edge
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+static inline int gen_write (FILE *fp, long m, const int *src, const int *dst)
+{
+  for (long i = 0; i < m; ++i)
+    if (fprintf(fp, "%d %d\n", src[i], dst[i]) < 0)
+      return 0;
+
+  return !fflush(fp);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,63 @@
+#include "parallel.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 500000
+#define LINES 3000000
+#define MAX_THREADS 32
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  char path[] = "/tmp/loader-XXXXXX";
+  int fd = mkstemp(path);
+  FILE *fp = fd < 0 ? NULL : fdopen(fd, "w+");
+  uint64_t seed = 23;
+  char label[64];
+  int ok = 1;
+  double t;
+
+  if (!fp)
+  {
+    fprintf(stderr, "Error: unable to create file\n");
+    return 1;
+  }
+
+  for (int i = 0; i < LINES; ++i) // some isolated vertices
+    if (i % 100 == 0)
+      fprintf(fp, "%d\n", (int) (bench_rand(&seed) % VERTICES));
+    else
+      fprintf(fp, "%d %d\n", gen_power_law(&seed, VERTICES), (int) (bench_rand(&seed) % VERTICES));
+
+  rewind(fp);
+  t = bench_now();
+  graph_t *expected = read_graph("loader", fp, 0);
+  bench_report("loader", "read_graph", LINES, bench_now() - t);
+  fclose(fp);
+
+  for (int threads = 1; threads <= MAX_THREADS && expected; threads *= 2)
+  {
+    t = bench_now();
+    graph_t *g = read_graph_parallel("loader", path, 0, threads);
+    snprintf(label, sizeof(label), "parallel, %d threads", threads);
+    bench_report("loader", label, LINES, bench_now() - t);
+
+    // same vertices in the same order and the same number of edges
+    for (int i = 0; ok && g && i < g->size; ++i)
+      ok = g->table[i]->id == expected->table[i]->id && g->table[i]->degree == expected->table[i]->degree;
+
+    if (!g || !ok || g->size != expected->size || edge_count(g, 0) != edge_count(expected, 0))
+    {
+      fprintf(stderr, "Error: read_graph_parallel differs from read_graph\n");
+      ok = 0;
+    }
+
+    destroy_graph(g);
+  }
+
+  destroy_graph(expected);
+  unlink(path);
+  return !ok || !expected;
+}
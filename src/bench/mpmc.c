@@ -0,0 +1,182 @@
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "mpmc.h"
+#include "queue.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define ITEMS 2000000
+#define CAPACITY 1024
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct node_t
+{
+  struct node_t *prev, *next ;
+  int value ;
+} node_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+// shared state of one run, with either the mpmc queue or a locked queue_t
+typedef struct run_t
+{
+  mpmc_t ring ;
+  queue_head_t queue ;
+  node_t *nodes ;
+  pthread_mutex_t lock ;
+  int locked ;
+  int producers ;
+  long consumed ;
+  long long sum ;
+} run_t ;
+
+typedef struct worker_t
+{
+  pthread_t thread ;
+  run_t *run ;
+  int id ;
+} worker_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int push (run_t *r, int value)
+{
+  if (!r->locked)
+    return mpmc_push(&r->ring, value);
+
+  // the nodes are preallocated, so only the queue itself is measured
+  pthread_mutex_lock(&r->lock);
+  r->nodes[value].value = value;
+  queue_append(&r->queue, (queue_t *) &r->nodes[value]);
+  pthread_mutex_unlock(&r->lock);
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int pop (run_t *r, int *value)
+{
+  if (!r->locked)
+    return mpmc_pop(&r->ring, value);
+
+  node_t *node;
+
+  pthread_mutex_lock(&r->lock);
+  node = (node_t *) queue_pop(&r->queue);
+  pthread_mutex_unlock(&r->lock);
+
+  if (node)
+    *value = node->value;
+
+  return node != NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void *produce (void *arg)
+{
+  worker_t *w = (worker_t *) arg;
+
+  // producer i sends the values i, i + producers, ...
+  for (int value = w->id; value < ITEMS; value += w->run->producers)
+    while (!push(w->run, value))
+      sched_yield();
+
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void *consume (void *arg)
+{
+  worker_t *w = (worker_t *) arg;
+  long long sum = 0;
+  int value;
+
+  while (__atomic_load_n(&w->run->consumed, __ATOMIC_RELAXED) < ITEMS)
+    if (pop(w->run, &value))
+    {
+      sum += value;
+      __atomic_fetch_add(&w->run->consumed, 1, __ATOMIC_RELAXED);
+    }
+    else
+      sched_yield();
+
+  __atomic_fetch_add(&w->run->sum, sum, __ATOMIC_RELAXED);
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int run (int locked, int threads)
+{
+  run_t r = { .locked = locked, .producers = threads };
+  worker_t *workers = (worker_t *) malloc(2 * threads * sizeof(worker_t));
+  char label[64];
+  double t;
+
+  if (locked)
+  {
+    r.nodes = (node_t *) malloc(ITEMS * sizeof(node_t));
+    pthread_mutex_init(&r.lock, NULL);
+  }
+  else
+    mpmc_init(&r.ring, CAPACITY);
+
+  t = bench_now();
+  for (int i = 0; i < 2 * threads; ++i)
+  {
+    workers[i].run = &r;
+    workers[i].id = i % threads;
+    pthread_create(&workers[i].thread, NULL, i < threads ? produce : consume, &workers[i]);
+  }
+
+  for (int i = 0; i < 2 * threads; ++i)
+    pthread_join(workers[i].thread, NULL);
+
+  snprintf(label, sizeof(label), "%s %dp/%dc", locked ? "queue_t + mutex" : "mpmc", threads, threads);
+  bench_report("mpmc", label, ITEMS, bench_now() - t);
+
+  if (locked)
+  {
+    free(r.nodes);
+    pthread_mutex_destroy(&r.lock);
+  }
+  else
+    mpmc_destroy(&r.ring);
+
+  free(workers);
+
+  // every value must be received exactly once
+  if (r.sum != (long long) ITEMS * (ITEMS - 1) / 2)
+  {
+    fprintf(stderr, "Error: %s lost or repeated values\n", label);
+    return 0;
+  }
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (int argc, char **argv)
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+  int ok = 1;
+
+  if (max_threads < 4)
+    max_threads = 4;
+
+  for (int threads = 1; threads <= max_threads; threads *= 2)
+  {
+    ok &= run(1, threads);
+    ok &= run(0, threads);
+  }
+
+  return !ok;
+}
@@ -0,0 +1,119 @@
+#include <math.h>
+
+#include "parallel.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 500000
+#define EDGES 4000000
+#define ITERATIONS 20
+#define MAX_THREADS 8
+
+/* ------------------------------------------------------------------------------ */
+
+// pagerank walking the edges lists: every vertex pushes its score to its
+// neighbours
+static void ring_pagerank (graph_t *g, double *rank, double *next, double damping, int iterations)
+{
+  for (int i = 0; i < g->size; ++i)
+    rank[i] = 1.0 / g->size;
+
+  for (int it = 0; it < iterations; ++it)
+  {
+    double lost = 0;
+
+    for (int i = 0; i < g->size; ++i)
+      if (!g->table[i]->degree)
+        lost += rank[i];
+
+    for (int i = 0; i < g->size; ++i)
+      next[i] = (1 - damping + damping * lost) / g->size;
+
+    for (int i = 0; i < g->size; ++i)
+    {
+      vertex_t *v = g->table[i];
+      edge_t *edge_it = v->edges;
+
+      if (edge_it)
+        do
+          next[edge_it->vertex->index] += damping * rank[i] / v->degree;
+        while ((edge_it = edge_it->next) != v->edges);
+    }
+
+    memcpy(rank, next, g->size * sizeof(double));
+  }
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  int *src = (int *) malloc(EDGES * sizeof(int));
+  int *dst = (int *) malloc(EDGES * sizeof(int));
+  graph_t *g = create_graph("pagerank");
+  uint64_t seed = 41;
+  char label[64];
+  int ok = 1;
+  double t;
+
+  if (!src || !dst || !g)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  // directed, the hubs receive most of the edges
+  for (int i = 0; i < EDGES; ++i)
+  {
+    src[i] = (int) (bench_rand(&seed) % VERTICES);
+    dst[i] = gen_power_law(&seed, VERTICES);
+  }
+
+  graph_add_edges(g, src, dst, EDGES, 0);
+  free(src);
+  free(dst);
+
+  csr_t *out = freeze_graph(g);
+  csr_t *in = csr_transpose(out);
+  double *expected = (double *) malloc(g->size * sizeof(double));
+  double *rank = (double *) malloc(g->size * sizeof(double));
+
+  if (!out || !in || !expected || !rank)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  t = bench_now();
+  ring_pagerank(g, expected, rank, 0.85, ITERATIONS);
+  bench_report("pagerank", "edges lists (iterations)", ITERATIONS, bench_now() - t);
+
+  // a tolerance of 0 runs every iteration
+  for (int threads = 1; threads <= MAX_THREADS; threads *= 2)
+  {
+    t = bench_now();
+    int iterations = pagerank(out, in, rank, 0.85, 0, ITERATIONS, threads);
+    snprintf(label, sizeof(label), "csr pull, %d threads", threads);
+    bench_report("pagerank", label, iterations, bench_now() - t);
+
+    for (int i = 0; ok && i < g->size; ++i)
+      ok = fabs(rank[i] - expected[i]) < 1e-12;
+  }
+
+  t = bench_now();
+  int iterations = pagerank(out, in, rank, 0.85, 1e-9, 1000, 1);
+  snprintf(label, sizeof(label), "converged to 1e-9 (%d it)", iterations);
+  bench_report("pagerank", label, iterations, bench_now() - t);
+
+  if (!ok || iterations < 0)
+    fprintf(stderr, "Error: pagerank differs from the edges lists version\n");
+
+  free(expected);
+  free(rank);
+  csr_destroy(out);
+  csr_destroy(in);
+  destroy_graph(g);
+
+  return !ok || iterations < 0;
+}
@@ -0,0 +1,76 @@
+#include "parallel.h"
+#include "traversal.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 1000000
+#define EDGES 4000000
+
+/* ------------------------------------------------------------------------------ */
+
+static int *expected;
+
+static int record_depth (vertex_t *v, int depth, void *arg)
+{
+  (void) arg;
+  expected[v->index] = depth;
+  return 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (int argc, char **argv)
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+  graph_t *g = create_graph("parallel");
+  uint64_t seed = 17;
+  char label[64];
+  double t;
+
+  for (int i = 0; i < VERTICES; ++i)
+    add_vertex(g, i, i);
+
+  for (int i = 0; i < EDGES; ++i) // undirected, with hubs
+  {
+    vertex_t *v1 = g->table[gen_power_law(&seed, VERTICES)];
+    vertex_t *v2 = g->table[bench_rand(&seed) % VERTICES];
+
+    if (!search_neighbourhood(v1, v2))
+    {
+      add_edge(v1, v2);
+      add_edge(v2, v1);
+    }
+  }
+
+  csr_t *c = freeze_graph(g);
+  int *depth = (int *) malloc(VERTICES * sizeof(int));
+
+  expected = (int *) malloc(VERTICES * sizeof(int));
+  for (int i = 0; i < VERTICES; ++i)
+    expected[i] = -1;
+
+  t = bench_now();
+  breadth_first_search(g, g->table[0], record_depth, NULL);
+  bench_report("parallel", "serial bfs (graph_t)", VERTICES, bench_now() - t);
+
+  for (int threads = 1; threads <= (max_threads > 1 ? max_threads : 1); threads *= 2)
+  {
+    t = bench_now();
+    parallel_bfs(c, NULL, 0, depth, threads);
+    snprintf(label, sizeof(label), "parallel_bfs %d threads", threads);
+    bench_report("parallel", label, VERTICES, bench_now() - t);
+
+    if (memcmp(depth, expected, VERTICES * sizeof(int)))
+    {
+      fprintf(stderr, "Error: parallel_bfs differs from breadth_first_search\n");
+      return 1;
+    }
+  }
+
+  free(depth);
+  free(expected);
+  csr_destroy(c);
+  destroy_graph(g);
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include "graph.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 1000000
+#define LINES 5000000
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  FILE *fp = tmpfile();
+  uint64_t seed = 11;
+  long bytes, sum = 0;
+  int ids[2], n;
+  double t;
+
+  if (!fp)
+  {
+    fprintf(stderr, "Error: unable to create file\n");
+    return 1;
+  }
+
+  for (int i = 0; i < LINES; ++i) // some isolated vertices and blank lines
+    if (i % 100 == 0)
+      fprintf(fp, "%d\n\n", (int) (bench_rand(&seed) % VERTICES));
+    else
+      fprintf(fp, "%d %d\n", gen_power_law(&seed, VERTICES), (int) (bench_rand(&seed) % VERTICES));
+
+  bytes = ftell(fp);
+  rewind(fp);
+
+  char *data = (char *) malloc(bytes);
+
+  if (!data || fread(data, 1, bytes, fp) != (size_t) bytes)
+  {
+    fprintf(stderr, "Error: unable to read file\n");
+    return 1;
+  }
+
+  reader_t r;
+
+  t = bench_now();
+  reader_init_memory(&r, data, bytes);
+  while ((n = reader_line(&r, ids)) > 0)
+    sum += ids[0];
+  bench_report_bytes("parse", "reader (memory)", bytes, bench_now() - t);
+
+  rewind(fp);
+  t = bench_now();
+  reader_init(&r, fp);
+  while ((n = reader_line(&r, ids)) > 0)
+    sum += ids[0];
+  reader_close(&r);
+  bench_report_bytes("parse", "reader (file)", bytes, bench_now() - t);
+
+  // the previous read_graph parsing loop
+  char line[256];
+
+  rewind(fp);
+  t = bench_now();
+  while (fgets(line, 256, fp))
+    if (line[0] != '\n' && sscanf(line, "%d %d", &ids[0], &ids[1]) > 0)
+      sum += ids[0];
+  bench_report_bytes("parse", "fgets + sscanf", bytes, bench_now() - t);
+
+  rewind(fp);
+  t = bench_now();
+  destroy_graph(read_graph("parse", fp, 1));
+  bench_report_bytes("parse", "read_graph (directed)", bytes, bench_now() - t);
+
+  free(data);
+  fclose(fp);
+  return sum == 0;
+}
@@ -0,0 +1,68 @@
+#include "graph.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 200000
+#define EDGES 4000000
+#define CHURN 20000
+
+/* ------------------------------------------------------------------------------ */
+
+static void run (const char *name, int flags)
+{
+  char label[64];
+  uint64_t seed = 42;
+  double t;
+
+  graph_t *g = create_graph_flags("pool", flags);
+
+  t = bench_now();
+  for (int i = 0; i < VERTICES; ++i)
+    add_vertex(g, i, i);
+  for (int i = 0; i < EDGES / 2; ++i) // undirected, both ends
+  {
+    vertex_t *v1 = get_vertex_by_id(g, bench_rand(&seed) % VERTICES);
+    vertex_t *v2 = get_vertex_by_id(g, bench_rand(&seed) % VERTICES);
+
+    add_edge(v1, v2);
+    add_edge(v2, v1);
+  }
+  snprintf(label, sizeof(label), "%s build", name);
+  bench_report("pool", label, VERTICES + EDGES, bench_now() - t);
+
+  // removes and re-adds vertices, so the freed nodes are reused
+  t = bench_now();
+  for (int i = 0; i < CHURN; ++i)
+  {
+    vertex_t *v = get_vertex_by_id(g, i);
+    int degree = v->degree;
+
+    release_vertex(g, remove_vertex(g, v, 0));
+    v = add_vertex(g, i, i);
+    for (int j = 0; j < degree; ++j)
+    {
+      vertex_t *u = get_vertex_by_id(g, bench_rand(&seed) % VERTICES);
+
+      add_edge(v, u);
+      add_edge(u, v);
+    }
+  }
+  snprintf(label, sizeof(label), "%s churn", name);
+  bench_report("pool", label, CHURN, bench_now() - t);
+
+  t = bench_now();
+  destroy_graph(g);
+  snprintf(label, sizeof(label), "%s destroy", name);
+  bench_report("pool", label, VERTICES + EDGES, bench_now() - t);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  run("pooled", 0);
+  run("malloc", GRAPH_NO_POOL);
+
+  return 0;
+}
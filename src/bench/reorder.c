@@ -0,0 +1,119 @@
+#include "parallel.h"
+#include "reorder.h"
+#include "traversal.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+// road network sized grid: SIDE x SIDE vertices, met in random order
+#define SIDE 1000
+#define ITERATIONS 10
+
+/* ------------------------------------------------------------------------------ */
+
+// times a bfs on the edges lists, a bfs on the csr and some pagerank
+// iterations, always from the same source vertex
+static int measure (graph_t *g, vertex_t *source, const char *order)
+{
+  csr_t *c = freeze_graph(g);
+  int *depth = (int *) malloc(g->size * sizeof(int));
+  double *rank = (double *) malloc(g->size * sizeof(double));
+  char label[64];
+  int ok = c && depth && rank;
+  double t;
+
+  if (ok)
+  {
+    t = bench_now();
+    ok &= breadth_first_search(g, source, NULL, NULL) == g->size;
+    snprintf(label, sizeof(label), "%s, edges lists bfs", order);
+    bench_report("reorder", label, g->size, bench_now() - t);
+
+    t = bench_now();
+    ok &= parallel_bfs(c, NULL, source->index, depth, 1) == g->size;
+    snprintf(label, sizeof(label), "%s, csr bfs", order);
+    bench_report("reorder", label, g->size, bench_now() - t);
+
+    t = bench_now();
+    ok &= pagerank(c, c, rank, 0.85, 0, ITERATIONS, 1) == ITERATIONS;
+    snprintf(label, sizeof(label), "%s, pagerank", order);
+    bench_report("reorder", label, (long) ITERATIONS * g->size, bench_now() - t);
+  }
+
+  csr_destroy(c);
+  free(depth);
+  free(rank);
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  long m = 2L * SIDE * (SIDE - 1);
+  int *src = (int *) malloc(m * sizeof(int));
+  int *dst = (int *) malloc(m * sizeof(int));
+  graph_t *g = create_graph("reorder");
+  const char *names[] = { "rcm", "degree", "bfs" };
+  uint64_t seed = 43;
+  int ok = 1;
+  double t;
+
+  if (!src || !dst || !g)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  gen_grid(SIDE, src, dst);
+
+  for (long i = m - 1; i > 0; --i) // shuffles the edges
+  {
+    long j = (long) (bench_rand(&seed) % (i + 1));
+    int a = src[i], b = dst[i];
+
+    src[i] = src[j];
+    dst[i] = dst[j];
+    src[j] = a;
+    dst[j] = b;
+  }
+
+  graph_add_edges(g, src, dst, m, BATCH_UNDIRECTED);
+  free(src);
+  free(dst);
+
+  vertex_t *source = get_vertex_by_id(g, 0);
+  vertex_t **original = (vertex_t **) malloc(g->size * sizeof(vertex_t *));
+  int *order = (int *) malloc(g->size * sizeof(int));
+
+  if (!source || !original || !order)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  memcpy(original, g->table, g->size * sizeof(vertex_t *));
+  ok &= measure(g, source, "file order");
+
+  for (int method = REORDER_RCM; method <= REORDER_BFS && ok; ++method)
+  {
+    t = bench_now();
+    ok &= reorder_graph(g, method);
+    bench_report("reorder", names[method], g->size, bench_now() - t);
+    ok &= measure(g, source, names[method]);
+
+    // back to the file order
+    for (int i = 0; i < g->size; ++i)
+      order[i] = original[i]->index;
+    ok &= relabel_graph(g, order);
+  }
+
+  if (!ok)
+    fprintf(stderr, "Error: reordering failed\n");
+
+  free(original);
+  free(order);
+  destroy_graph(g);
+
+  return !ok;
+}
@@ -0,0 +1,156 @@
+#include "graph.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 200000
+#define EDGES 1000000
+#define SNAPSHOTS 100000
+
+/* ------------------------------------------------------------------------------ */
+
+// bytes of the nodes of the version a that the version b does not share
+static size_t unshared (const snapshot_node_t *a, const snapshot_node_t *b)
+{
+  if (!a || a == b)
+    return 0;
+
+  if (a->leaf)
+    return sizeof(snapshot_vertex_t) + ((const snapshot_vertex_t *) a)->capacity * sizeof(int);
+
+  const snapshot_branch_t *x = (const snapshot_branch_t *) a;
+  const snapshot_branch_t *y = (b && !b->leaf) ? (const snapshot_branch_t *) b : NULL;
+  size_t bytes = sizeof(snapshot_branch_t);
+
+  for (int k = 0; k < SNAPSHOT_FANOUT; ++k)
+    bytes += unshared(x->child[k], y ? y->child[k] : NULL);
+
+  return bytes;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// builds the same random graph with the given flags
+static graph_t *build (int flags, const int *src, const int *dst, const char *label)
+{
+  graph_t *g = create_graph_flags("snapshot", flags);
+  double t = bench_now();
+
+  if (!g || graph_add_edges(g, src, dst, EDGES, 0) < 0)
+  {
+    destroy_graph(g);
+    return NULL;
+  }
+
+  bench_report("snapshot", label, EDGES, bench_now() - t);
+  return g;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// times single edge inserts, taking (and keeping) a snapshot every period
+// edges (0 for none)
+static int insert_edges (graph_t *g, uint64_t *seed, int period, const char *label)
+{
+  snapshot_t *held = NULL;
+  int ok = 1;
+  double t = bench_now();
+
+  for (int i = 0; i < EDGES / 10 && ok; ++i)
+  {
+    vertex_t *v1 = g->table[bench_rand(seed) % g->size];
+    vertex_t *v2 = g->table[bench_rand(seed) % g->size];
+
+    ok &= add_edge(v1, v2);
+
+    if (period && !(i % period))
+    {
+      snapshot_release(held);
+      ok &= (held = graph_snapshot(g)) != NULL;
+    }
+  }
+
+  bench_report("snapshot", label, EDGES / 10, bench_now() - t);
+  snapshot_release(held);
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  int *src = (int *) malloc(EDGES * sizeof(int));
+  int *dst = (int *) malloc(EDGES * sizeof(int));
+  uint64_t seed = 47;
+  char label[64];
+  int ok = 1;
+  double t;
+
+  if (!src || !dst)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  gen_erdos_renyi(&seed, VERTICES, EDGES, src, dst);
+
+  graph_t *plain = build(0, src, dst, "build, no version");
+  graph_t *g = build(GRAPH_SNAPSHOTS, src, dst, "build, versioned");
+
+  free(src);
+  free(dst);
+
+  if (!plain || !g)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  // without GRAPH_SNAPSHOTS the first snapshot builds the version
+  t = bench_now();
+  snapshot_t *first = graph_snapshot(plain);
+  bench_report("snapshot", "first snapshot, O(V + E)", 1, bench_now() - t);
+  ok &= first != NULL;
+  snapshot_release(first);
+  destroy_graph(plain);
+
+  t = bench_now();
+  for (int i = 0; i < SNAPSHOTS && ok; ++i)
+  {
+    snapshot_t *s = graph_snapshot(g);
+
+    ok &= s != NULL;
+    snapshot_release(s);
+  }
+  bench_report("snapshot", "take and release, O(1)", SNAPSHOTS, bench_now() - t);
+
+  snapshot_t *base = graph_snapshot(g);
+
+  ok &= base != NULL;
+  snprintf(label, sizeof(label), "whole version, %zu B/vertex", ok ? unshared(base->root, NULL) / g->size : 0);
+  bench_report_bytes("snapshot", label, ok ? unshared(base->root, NULL) : 0, 0);
+
+  // the memory a snapshot holds grows with the vertices changed after it
+  for (int changed = 10, done = 0; changed <= VERTICES / 2 && ok; changed *= 10)
+  {
+    for (; done < changed; ++done)
+      ok &= add_edge(g->table[done], g->table[(done + 1) % g->size]);
+
+    size_t bytes = unshared(g->version, base->root);
+
+    snprintf(label, sizeof(label), "%d changed, %zu B/changed vertex", changed, bytes / changed);
+    bench_report_bytes("snapshot", label, bytes, 0);
+  }
+
+  snapshot_release(base);
+
+  ok &= insert_edges(g, &seed, 0, "add_edge, no snapshot held");
+  ok &= insert_edges(g, &seed, 1000, "add_edge, snapshot per 1000");
+  ok &= insert_edges(g, &seed, 10, "add_edge, snapshot per 10");
+
+  if (!ok)
+    fprintf(stderr, "Error: snapshot failed\n");
+
+  destroy_graph(g);
+  return !ok;
+}
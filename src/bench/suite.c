@@ -0,0 +1,161 @@
+#include "graph.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define LOOKUPS 1000000
+#define REMOVALS 20000
+
+/* ------------------------------------------------------------------------------
+ * function: run
+ * ------------------------------------------------------------------------------
+ * times the graph operations on one generated undirected graph
+ *
+ * label: generator name (also the graph name)
+ * m: number of edges
+ * src: source of each edge
+ * dst: destination of each edge
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+static int run (char *label, long m, const int *src, const int *dst)
+{
+  FILE *fp = tmpfile(), *out = tmpfile();
+  uint64_t seed = 29;
+  char name[64];
+  double t;
+
+  if (!fp || !out || !gen_write(fp, m, src, dst))
+  {
+    fprintf(stderr, "Error: unable to write %s\n", label);
+    if (fp)
+      fclose(fp);
+    if (out)
+      fclose(out);
+    return 0;
+  }
+
+  rewind(fp);
+  t = bench_now();
+  graph_t *g = read_graph(label, fp, 0);
+  snprintf(name, sizeof(name), "%s/read_graph", label);
+  bench_report("suite", name, m, bench_now() - t);
+  fclose(fp);
+
+  if (!g || !g->size)
+  {
+    fprintf(stderr, "Error: unable to read %s\n", label);
+    fclose(out);
+    destroy_graph(g);
+    return 0;
+  }
+
+  t = bench_now();
+  graph_t *written = write_graph(g, out, 0);
+  snprintf(name, sizeof(name), "%s/write_graph", label);
+  bench_report("suite", name, edge_count(g, 0), bench_now() - t);
+  fclose(out);
+
+  if (!written)
+  {
+    fprintf(stderr, "Error: unable to write %s\n", label);
+    destroy_graph(g);
+    return 0;
+  }
+
+  // ids of the generated edges, so most lookups hit
+  t = bench_now();
+  for (long i = 0; i < LOOKUPS; ++i)
+    get_vertex_by_id(g, src[bench_rand(&seed) % m]);
+  snprintf(name, sizeof(name), "%s/get_vertex_by_id", label);
+  bench_report("suite", name, LOOKUPS, bench_now() - t);
+
+  // half of the pairs are edges, the other half random
+  t = bench_now();
+  for (long i = 0; i < LOOKUPS; ++i)
+  {
+    vertex_t *v1 = g->table[bench_rand(&seed) % g->size];
+    vertex_t *v2 = i & 1 || !v1->degree ? g->table[bench_rand(&seed) % g->size] : v1->edges->vertex;
+
+    search_neighbourhood(v1, v2);
+  }
+  snprintf(name, sizeof(name), "%s/search_neighbourhood", label);
+  bench_report("suite", name, LOOKUPS, bench_now() - t);
+
+  int removals = g->size < REMOVALS ? g->size : REMOVALS;
+
+  t = bench_now();
+  for (int i = 0; i < removals; ++i)
+    release_vertex(g, remove_vertex(g, g->table[bench_rand(&seed) % g->size], 0));
+  snprintf(name, sizeof(name), "%s/remove_vertex", label);
+  bench_report("suite", name, removals, bench_now() - t);
+
+  long size = g->size + edge_count(g, 0);
+
+  t = bench_now();
+  destroy_graph(g);
+  snprintf(name, sizeof(name), "%s/destroy_graph", label);
+  bench_report("suite", name, size, bench_now() - t);
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------
+ * the scale (environment variable BENCH_SCALE, 1 by default) multiplies the
+ * number of vertices and edges of every generated graph
+ * ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  const char *env = getenv("BENCH_SCALE");
+  int scale = env ? atoi(env) : 1;
+  uint64_t seed = 31;
+  int ok = 1, rmat = 17;
+
+  if (scale < 1 || scale > 64)
+  {
+    fprintf(stderr, "Error: BENCH_SCALE must be between 1 and 64\n");
+    return 1;
+  }
+
+  for (int s = scale; s > 1; s >>= 1)
+    ++rmat;
+
+  int n = 100000 * scale, side = 300;
+  long m = 1000000L * scale;
+
+  while ((long) side * side < 90000L * scale) // about 90000 * scale vertices
+    ++side;
+
+  long max = m > 3L * n ? m : 3L * n;
+
+  if (max < 2L * side * (side - 1))
+    max = 2L * side * (side - 1);
+
+  int *src = (int *) malloc(max * sizeof(int));
+  int *dst = (int *) malloc(max * sizeof(int));
+
+  if (!src || !dst)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    free(src);
+    free(dst);
+    return 1;
+  }
+
+  gen_erdos_renyi(&seed, n, m, src, dst);
+  ok &= run("gnm", m, src, dst);
+
+  gen_rmat(&seed, rmat, m, src, dst);
+  ok &= run("rmat", m, src, dst);
+
+  ok &= run("grid", gen_grid(side, src, dst), src, dst);
+
+  ok &= run("petersen", gen_petersen(n, 2, src, dst), src, dst);
+
+  free(src);
+  free(dst);
+
+  return !ok;
+}
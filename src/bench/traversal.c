@@ -0,0 +1,106 @@
+#include "traversal.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 1000000
+#define EDGES 3000000
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct node_t
+{
+  struct node_t *prev, *next ;
+  vertex_t *vertex ;
+} node_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+// the traversal users had to write: one queue_t node per visit
+static int queue_bfs (graph_t *g, vertex_t *source)
+{
+  unsigned char *visited = (unsigned char *) calloc(g->size, sizeof(unsigned char));
+  node_t *node = (node_t *) malloc(sizeof(node_t));
+  queue_head_t queue;
+  int count = 0;
+
+  queue_init(&queue);
+
+  node->vertex = source;
+  visited[source->index] = 1;
+  queue_append(&queue, (queue_t *) node);
+
+  while ((node = (node_t *) queue_pop(&queue)))
+  {
+    edge_t *edge_it = node->vertex->edges;
+
+    if (edge_it)
+      do
+        if (!visited[edge_it->vertex->index])
+        {
+          node_t *next = (node_t *) malloc(sizeof(node_t));
+
+          visited[edge_it->vertex->index] = 1;
+          next->vertex = edge_it->vertex;
+          queue_append(&queue, (queue_t *) next);
+        }
+      while ((edge_it = edge_it->next) != node->vertex->edges);
+
+    free(node);
+    count++;
+  }
+
+  free(visited);
+  return count;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  graph_t *g = create_graph("traversal");
+  int *component = (int *) malloc(VERTICES * sizeof(int));
+  uint64_t seed = 13;
+  long total = 0;
+  double t;
+
+  for (int i = 0; i < VERTICES; ++i)
+    add_vertex(g, i, i);
+
+  for (int i = 0; i < EDGES; ++i) // sparse, undirected
+  {
+    vertex_t *v1 = g->table[bench_rand(&seed) % VERTICES];
+    vertex_t *v2 = g->table[bench_rand(&seed) % VERTICES];
+
+    if (!search_neighbourhood(v1, v2))
+    {
+      add_edge(v1, v2);
+      add_edge(v2, v1);
+    }
+  }
+
+  t = bench_now();
+  total += breadth_first_search(g, g->table[0], NULL, NULL);
+  bench_report("traversal", "breadth_first_search", VERTICES, bench_now() - t);
+
+  t = bench_now();
+  total += queue_bfs(g, g->table[0]);
+  bench_report("traversal", "bfs with queue_t nodes", VERTICES, bench_now() - t);
+
+  t = bench_now();
+  total += depth_first_search(g, g->table[0], NULL, NULL);
+  bench_report("traversal", "depth_first_search", VERTICES, bench_now() - t);
+
+  t = bench_now();
+  total += connected_components(g, component);
+  bench_report("traversal", "connected_components", VERTICES, bench_now() - t);
+
+  t = bench_now();
+  for (int i = 1; i <= 10; ++i)
+    total += shortest_path(g, g->table[i], g->table[VERTICES - i], NULL);
+  bench_report("traversal", "shortest_path", 10, bench_now() - t);
+
+  free(component);
+  destroy_graph(g);
+  return total < 0;
+}
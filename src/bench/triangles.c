@@ -0,0 +1,97 @@
+#include "triangles.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 50000
+#define EDGES 300000
+#define MAX_THREADS 8
+
+/* ------------------------------------------------------------------------------ */
+
+// counts the triangles through v with search_neighbourhood on every pair of
+// neighbours, O(degree^2)
+static long naive_triangles (vertex_t *v)
+{
+  edge_t *a = v->edges, *b;
+  long count = 0;
+
+  if (a)
+    do
+      for (b = a->next; b != v->edges; b = b->next)
+        if (a->vertex != v && b->vertex != v && search_neighbourhood(a->vertex, b->vertex))
+          count++;
+    while ((a = a->next) != v->edges);
+
+  return count;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  int *src = (int *) malloc(EDGES * sizeof(int));
+  int *dst = (int *) malloc(EDGES * sizeof(int));
+  graph_t *g = create_graph("triangles");
+  uint64_t seed = 37;
+  long naive = 0, expected = -1, total;
+  char label[64];
+  int ok = 1;
+  double t;
+
+  if (!src || !dst || !g)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  for (int i = 0; i < EDGES; ++i)
+  {
+    src[i] = gen_power_law(&seed, VERTICES);
+    dst[i] = (int) (bench_rand(&seed) % VERTICES);
+  }
+
+  graph_add_edges(g, src, dst, EDGES, BATCH_UNDIRECTED);
+  csr_t *c = freeze_graph(g);
+
+  if (!c)
+  {
+    fprintf(stderr, "Error: out of memory\n");
+    return 1;
+  }
+
+  // every triangle is seen from its 3 vertices
+  t = bench_now();
+  for (int i = 0; i < g->size; ++i)
+    naive += naive_triangles(g->table[i]);
+  bench_report("triangles", "search_neighbourhood pairs", g->size, bench_now() - t);
+
+  for (int threads = 1; threads <= MAX_THREADS; threads *= 2)
+  {
+    t = bench_now();
+    total = count_triangles(c, NULL, threads);
+    snprintf(label, sizeof(label), "count_triangles, %d threads", threads);
+    bench_report("triangles", label, g->size, bench_now() - t);
+
+    if (expected < 0)
+      expected = total;
+    ok &= total == expected && 3 * total == naive;
+  }
+
+  t = bench_now();
+  double global = global_clustering(c, 1);
+  bench_report("triangles", "global_clustering", g->size, bench_now() - t);
+
+  if (!ok || global < 0)
+  {
+    fprintf(stderr, "Error: triangle counts differ (%ld, %ld)\n", expected, naive / 3);
+    ok = 0;
+  }
+
+  free(src);
+  free(dst);
+  csr_destroy(c);
+  destroy_graph(g);
+
+  return !ok;
+}
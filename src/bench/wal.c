@@ -0,0 +1,111 @@
+#include "wal.h"
+#include "bench/gen.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 200000
+#define EDGES 1000000
+#define SYNCED_CHANGES 2000
+
+/* ------------------------------------------------------------------------------ */
+
+// adds random edges to a logged graph and syncs the log, like a checkpoint
+static int changes (graph_t *g, wal_t *w, uint64_t *seed, int n, const char *label)
+{
+  int ok = 1;
+  double t = bench_now();
+
+  for (int i = 0; i < n && ok; ++i)
+    ok &= add_edge(g->table[bench_rand(seed) % g->size], g->table[bench_rand(seed) % g->size]);
+
+  ok &= wal_sync(w);
+  bench_report("wal", label, n, bench_now() - t);
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  char text_path[] = "/tmp/queue-graph-XXXXXX", log_path[] = "/tmp/queue-graph-XXXXXX";
+  int text_fd = mkstemp(text_path), log_fd = mkstemp(log_path);
+  int *src = (int *) malloc(EDGES * sizeof(int));
+  int *dst = (int *) malloc(EDGES * sizeof(int));
+  graph_t *g = create_graph("wal");
+  FILE *text;
+  uint64_t seed = 53;
+  char label[64];
+  int ok = 1;
+  double t;
+
+  if (text_fd < 0 || log_fd < 0 || !(text = fdopen(text_fd, "w")) || !src || !dst || !g)
+  {
+    fprintf(stderr, "Error: unable to create file\n");
+    return 1;
+  }
+
+  close(log_fd); // wal_open writes the header of the empty file
+  gen_erdos_renyi(&seed, VERTICES, EDGES, src, dst);
+
+  wal_t *w = wal_open(log_path, 0);
+
+  if (!w)
+  {
+    fprintf(stderr, "Error: unable to open log\n");
+    return 1;
+  }
+
+  wal_attach(w, g);
+  t = bench_now();
+  ok &= graph_add_edges(g, src, dst, EDGES, BATCH_UNDIRECTED) >= 0;
+  ok &= wal_sync(w);
+  bench_report_bytes("wal", "batch logged and synced", w->bytes, bench_now() - t);
+  free(src);
+  free(dst);
+
+  // a full dump costs O(V + E) whatever changed, a checkpoint only the changes
+  t = bench_now();
+  ok &= write_graph(g, text, 0) != NULL && !fflush(text) && !fsync(text_fd);
+  bench_report("wal", "full write_graph dump", edge_count(g, 0), bench_now() - t);
+
+  ok &= changes(g, w, &seed, 100, "checkpoint, 100 changes");
+  ok &= changes(g, w, &seed, 10000, "checkpoint, 10000 changes");
+
+  // group commit: one fsync per sync_every records
+  for (int every = 1; every <= 1024 && ok; every *= 32)
+  {
+    w->sync_every = every;
+    t = bench_now();
+    for (int i = 0; i < SYNCED_CHANGES && ok; ++i)
+      ok &= add_edge(g->table[bench_rand(&seed) % g->size], g->table[bench_rand(&seed) % g->size]);
+    snprintf(label, sizeof(label), "add_edge, fsync every %d", every);
+    bench_report("wal", label, SYNCED_CHANGES, bench_now() - t);
+  }
+
+  w->sync_every = 0;
+
+  snprintf(label, sizeof(label), "compact, %zu B log", w->bytes);
+  t = bench_now();
+  ok &= wal_compact(w, g);
+  bench_report_bytes("wal", label, w->bytes, bench_now() - t);
+
+  wal_attach(NULL, g);
+  ok &= wal_close(w);
+
+  graph_t *r = create_graph("replay");
+
+  t = bench_now();
+  ok &= r && wal_replay(log_path, r) > 0 && r->size == g->size && edge_count(r, 1) == edge_count(g, 1);
+  bench_report("wal", "replay compacted log", edge_count(g, 1), bench_now() - t);
+
+  if (!ok)
+    fprintf(stderr, "Error: log failed\n");
+
+  fclose(text);
+  unlink(text_path);
+  unlink(log_path);
+  destroy_graph(g);
+  destroy_graph(r);
+
+  return !ok;
+}
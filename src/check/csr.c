@@ -0,0 +1,314 @@
+#include <limits.h>
+
+#include "csr.h"
+#include "reorder.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 2000
+#define EDGES 10000
+#define REMOVED 300
+
+// byte positions of some header fields of the binary format (see csr.c)
+#define HEADER_SIZE 24
+#define HEADER_EDGES 32
+#define HEADER_NAME 80
+#define HEADER_FILE_SIZE 88
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct
+{
+  int a, b ;
+} line_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int failures = 0;
+
+/* ------------------------------------------------------------------------------ */
+
+static void check (int ok, const char *what)
+{
+  if (!ok)
+  {
+    fprintf(stderr, "Error: %s\n", what);
+    failures++;
+  }
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// writes a graph (or its frozen copy, if c is not NULL) to a string
+static char *capture (graph_t *g, csr_t *c, int is_directed)
+{
+  char *text = NULL;
+  size_t size = 0;
+  FILE *output = open_memstream(&text, &size);
+
+  if (!output)
+    return NULL;
+
+  int ok = c ? csr_write(c, output, is_directed) != NULL : write_graph(g, output, is_directed) != NULL;
+
+  if (fclose(output) || !ok)
+  {
+    free(text);
+    return NULL;
+  }
+
+  return text;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int compare_lines (const void *x, const void *y)
+{
+  const line_t *l1 = (const line_t *) x, *l2 = (const line_t *) y;
+
+  if (l1->a != l2->a)
+    return l1->a < l2->a ? -1 : 1;
+
+  return (l1->b > l2->b) - (l1->b < l2->b);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// sorted lines of a written graph, an undirected edge always as (low, high)
+// and an isolated vertex as (id, INT_MIN)
+static line_t *parse (const char *text, int is_directed, size_t *count)
+{
+  size_t n = 0, capacity = 64;
+  line_t *lines = (line_t *) malloc(capacity * sizeof(line_t));
+
+  for (const char *p = text; lines && *p; p = strchr(p, '\n') + 1)
+  {
+    line_t l = { 0, INT_MIN };
+    char *end;
+
+    // sscanf would read the id of the next line after an isolated vertex
+    l.a = (int) strtol(p, &end, 10);
+    if (*end == ' ')
+      l.b = (int) strtol(end, &end, 10);
+
+    if (end == p || *end != '\n')
+    {
+      free(lines);
+      return NULL;
+    }
+
+    if (!is_directed && l.b != INT_MIN && l.b < l.a)
+      l = (line_t) { l.b, l.a };
+
+    if (n == capacity)
+    {
+      line_t *grown = (line_t *) realloc(lines, 2 * capacity * sizeof(line_t));
+
+      if (!grown)
+      {
+        free(lines);
+        return NULL;
+      }
+
+      lines = grown;
+      capacity *= 2;
+    }
+
+    lines[n++] = l;
+  }
+
+  if (lines)
+    qsort(lines, n, sizeof(line_t), compare_lines);
+
+  *count = n;
+  return lines;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// freezes a graph and compares csr_write with write_graph: the same text
+// while the dense indices follow g->vertices, the same lines otherwise
+static void round_trip (graph_t *g, int is_directed, int same_order, const char *what)
+{
+  csr_t *c = freeze_graph(g);
+  char *expected = capture(g, NULL, is_directed);
+  char *written = c ? capture(NULL, c, is_directed) : NULL;
+  size_t n1 = 0, n2 = 0;
+
+  check(expected && written, what);
+
+  if (expected && written)
+  {
+    if (same_order)
+      check(!strcmp(expected, written), what);
+
+    line_t *l1 = parse(expected, is_directed, &n1);
+    line_t *l2 = parse(written, is_directed, &n2);
+
+    check(l1 && l2 && n1 == n2 && !memcmp(l1, l2, n1 * sizeof(line_t)), what);
+    free(l1);
+    free(l2);
+  }
+
+  free(expected);
+  free(written);
+  csr_destroy(c);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void check_petersen (int is_directed)
+{
+  FILE *input = fopen("petersen", "r");
+
+  check(input != NULL, "unable to open petersen");
+  if (!input)
+    return;
+
+  graph_t *g = read_graph("petersen", input, is_directed);
+
+  fclose(input);
+  check(g != NULL, "unable to read petersen");
+  if (g)
+    round_trip(g, is_directed, 1, is_directed ? "petersen, directed" : "petersen, undirected");
+
+  destroy_graph(g);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void check_random (int is_directed)
+{
+  graph_t *g = create_graph("random");
+  uint64_t seed = 59;
+  int ok = g != NULL;
+
+  for (int i = 0; i < VERTICES && ok; ++i)
+    ok = add_vertex(g, i, i) != NULL;
+
+  for (int i = 0; i < EDGES && ok; ++i)
+  {
+    vertex_t *v1 = g->table[bench_rand(&seed) % g->size];
+    vertex_t *v2 = g->table[bench_rand(&seed) % g->size];
+
+    // read_graph skips the repeated undirected edges too
+    if (!search_neighbourhood(v1, v2))
+      ok = add_edge(v1, v2) && (is_directed || v1 == v2 || add_edge(v2, v1));
+  }
+
+  check(ok, "unable to build the random graph");
+  if (!ok)
+  {
+    destroy_graph(g);
+    return;
+  }
+
+  round_trip(g, is_directed, 1, "random graph");
+
+  // a removed vertex gives its index to the last one
+  for (int i = 0; i < REMOVED; ++i)
+    release_vertex(g, remove_vertex(g, g->table[bench_rand(&seed) % g->size], is_directed));
+
+  round_trip(g, is_directed, 0, "random graph, after removals");
+
+  check(reorder_graph(g, REORDER_RCM), "unable to relabel the random graph");
+  round_trip(g, is_directed, 0, "random graph, after relabel_graph");
+
+  destroy_graph(g);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// writes bytes to a file, with a header field changed (if field is not 0)
+static int rewrite (const char *path, const char *bytes, size_t n, int field, uint64_t value)
+{
+  FILE *output = fopen(path, "w");
+  char *copy = (char *) malloc(n);
+  int ok = output && copy;
+
+  if (ok)
+  {
+    memcpy(copy, bytes, n);
+    if (field)
+      memcpy(copy + field, &value, sizeof(uint64_t));
+    ok = fwrite(copy, 1, n, output) == n;
+  }
+
+  if (output)
+    ok &= !fclose(output);
+
+  free(copy);
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// the binary file must map back to the same graph, the corrupt ones not at all
+static void check_binary (void)
+{
+  char path[] = "/tmp/queue-graph-XXXXXX";
+  int fd = mkstemp(path);
+  FILE *input = fopen("petersen", "r");
+  graph_t *g = input ? read_graph("petersen", input, 0) : NULL;
+  char *bytes = NULL;
+  size_t n = 0;
+  FILE *output = open_memstream(&bytes, &n);
+  int ok = fd >= 0 && g && output && write_graph_binary(g, output);
+
+  if (output)
+    ok &= !fclose(output);
+
+  ok = ok && rewrite(path, bytes, n, 0, 0);
+  check(ok, "unable to write the binary file");
+
+  if (ok)
+  {
+    csr_t *c = csr_map(path);
+    char *expected = capture(g, NULL, 0);
+    char *written = c ? capture(NULL, c, 0) : NULL;
+
+    check(expected && written && !strcmp(expected, written), "binary file, mapped");
+    free(expected);
+    free(written);
+    csr_destroy(c);
+
+    uint64_t file_size = n;
+
+    check(rewrite(path, bytes, n - 1, 0, 0) && !csr_map(path), "binary file, truncated");
+    check(rewrite(path, bytes, HEADER_FILE_SIZE, 0, 0) && !csr_map(path), "binary file, cut in the header");
+    check(rewrite(path, bytes, n - 1, HEADER_FILE_SIZE, file_size - 1) && !csr_map(path),
+          "binary file, truncated with its file size");
+    check(rewrite(path, bytes, n, HEADER_NAME, file_size + 8) && !csr_map(path), "binary file, name after the end");
+    check(rewrite(path, bytes, n, HEADER_EDGES, UINT64_MAX / 2) && !csr_map(path), "binary file, too many edges");
+    check(rewrite(path, bytes, n, HEADER_SIZE, 2147483647ULL) && !csr_map(path), "binary file, too many vertices");
+  }
+
+  if (fd >= 0)
+  {
+    close(fd);
+    unlink(path);
+  }
+
+  if (input)
+    fclose(input);
+
+  free(bytes);
+  destroy_graph(g);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  check_petersen(0);
+  check_petersen(1);
+  check_random(0);
+  check_random(1);
+  check_binary();
+
+  if (!failures)
+    printf("csr: ok\n");
+
+  return failures != 0;
+}
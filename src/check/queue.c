@@ -0,0 +1,200 @@
+#include "graph.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define ITEMS 8
+#define VERTICES 500
+#define EDGES 3000
+#define REMOVED 100
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct
+{
+  queue_t node ;
+  int value ;
+} item_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int failures = 0;
+
+/* ------------------------------------------------------------------------------ */
+
+static void check (int ok, const char *what)
+{
+  if (!ok)
+  {
+    fprintf(stderr, "Error: %s\n", what);
+    failures++;
+  }
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// number of elements found walking a queue (what queue_size used to do)
+static unsigned int walk (const queue_head_t *queue)
+{
+  unsigned int n = 0;
+  queue_t *it = queue->first;
+
+  if (it)
+    do
+      n++;
+    while ((it = it->next) != queue->first);
+
+  return n;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// verifies the values of a queue, in order, both ways and as a circle, and
+// its stored size
+static int holds (queue_head_t *queue, const int *values, int n)
+{
+  queue_t *it = queue->first;
+
+  if (queue_size(queue) != (unsigned int) n)
+    return 0;
+
+  if (!n)
+    return !it;
+
+  for (int i = 0; i < n; ++i, it = it->next)
+    if (!it || ((item_t *) it)->value != values[i] || it->next->prev != it)
+      return 0;
+
+  if (it != queue->first)
+    return 0;
+
+  for (int i = n - 1; i >= 0; --i)
+    if (((item_t *) (it = it->prev))->value != values[i])
+      return 0;
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void check_queue (item_t *items)
+{
+  queue_head_t queue, other;
+
+  queue_init(&queue);
+  queue_init(&other);
+
+  check(!queue_pop(&queue) && holds(&queue, NULL, 0), "queue_pop, empty");
+  check(!queue_size(NULL), "queue_size, NULL");
+
+  queue_append(&queue, &(items[0].node));
+  check(holds(&queue, (int[]) { 0 }, 1), "queue_append, single");
+  check(queue_pop(&queue) == &(items[0].node) && holds(&queue, NULL, 0), "queue_pop, single");
+
+  queue_prepend(&queue, &(items[1].node));
+  check(holds(&queue, (int[]) { 1 }, 1), "queue_prepend, empty");
+  check(queue_remove(&queue, &(items[1].node)) == &(items[1].node) && holds(&queue, NULL, 0),
+        "queue_remove, single");
+
+  for (int i = 1; i < ITEMS / 2; ++i)
+    queue_append(&queue, &(items[i].node));
+  queue_prepend(&queue, &(items[0].node));
+  check(holds(&queue, (int[]) { 0, 1, 2, 3 }, 4), "queue_append and queue_prepend");
+
+  queue_remove(&queue, &(items[1].node));
+  check(holds(&queue, (int[]) { 0, 2, 3 }, 3), "queue_remove, middle");
+  queue_remove(&queue, &(items[3].node));
+  check(holds(&queue, (int[]) { 0, 2 }, 2), "queue_remove, last");
+  queue_remove(&queue, &(items[0].node));
+  check(holds(&queue, (int[]) { 2 }, 1), "queue_remove, first");
+
+  queue_splice(&queue, &other);
+  check(holds(&queue, (int[]) { 2 }, 1) && holds(&other, NULL, 0), "queue_splice, empty other");
+
+  for (int i = ITEMS / 2; i < ITEMS; ++i)
+    queue_append(&other, &(items[i].node));
+  queue_splice(&queue, &other);
+  check(holds(&queue, (int[]) { 2, 4, 5, 6, 7 }, 5) && holds(&other, NULL, 0), "queue_splice");
+
+  queue_splice(&other, &queue);
+  check(holds(&other, (int[]) { 2, 4, 5, 6, 7 }, 5) && holds(&queue, NULL, 0), "queue_splice, empty queue");
+
+  for (int i = 0; i < 5; ++i)
+    check(queue_pop(&other) == &(items[i ? i + 3 : 2].node), "queue_pop, order");
+
+  check(holds(&other, NULL, 0), "queue_pop, until empty");
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// the vertices, edges and in-edges lists of a graph keep their sizes through
+// every change
+static void check_graph (int flags)
+{
+  graph_t *g = create_graph_flags("queue", flags);
+  int src[EDGES], dst[EDGES];
+  uint64_t seed = 61;
+  int ok = g != NULL;
+
+  for (int i = 0; i < EDGES; ++i)
+  {
+    src[i] = (int) (bench_rand(&seed) % VERTICES);
+    dst[i] = (int) (bench_rand(&seed) % VERTICES);
+  }
+
+  // single edges, a batch and removals of edges and vertices
+  for (int i = 0; i < EDGES / 2 && ok; ++i)
+    ok = add_edge(find_or_add_vertex(g, src[i], src[i]), find_or_add_vertex(g, dst[i], dst[i]));
+
+  ok = ok && graph_add_edges(g, src + EDGES / 2, dst + EDGES / 2, EDGES / 2, BATCH_UNDIRECTED) >= 0;
+
+  for (int i = 0; i < EDGES / 4 && ok; ++i)
+    release_edge(g, remove_edge(get_vertex_by_id(g, src[i]), get_vertex_by_id(g, dst[i])));
+
+  for (int i = 0; i < REMOVED && ok; ++i)
+    release_vertex(g, remove_vertex(g, g->table[bench_rand(&seed) % g->size], 1));
+
+  check(ok, "unable to build the graph");
+
+  if (ok)
+  {
+    long in_degrees = 0, degrees = 0;
+
+    ok = queue_size(&(g->vertex_list)) == (unsigned int) g->size && walk(&(g->vertex_list)) == (unsigned int) g->size;
+
+    for (int i = 0; i < g->size && ok; ++i)
+    {
+      vertex_t *v = g->table[i];
+
+      ok = queue_size(&(v->edge_list)) == (unsigned int) v->degree && walk(&(v->edge_list)) == (unsigned int) v->degree &&
+           queue_size(&(v->in_edge_list)) == walk(&(v->in_edge_list));
+      degrees += v->degree;
+      in_degrees += queue_size(&(v->in_edge_list));
+    }
+
+    check(ok && (!(flags & GRAPH_IN_EDGES) || in_degrees == degrees), "graph lists, sizes");
+  }
+
+  destroy_graph(g);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  item_t items[ITEMS];
+
+  memset(items, 0, sizeof(items));
+  for (int i = 0; i < ITEMS; ++i)
+    items[i].value = i;
+
+  check_queue(items);
+  check_graph(0);
+  check_graph(GRAPH_IN_EDGES);
+  check_graph(GRAPH_IN_EDGES | GRAPH_NO_POOL);
+
+  if (!failures)
+    printf("queue: ok\n");
+
+  return failures != 0;
+}
@@ -0,0 +1,177 @@
+#include <math.h>
+
+#include "triangles.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 200
+#define EDGES 2000
+#define MAX_THREADS 8
+
+/* ------------------------------------------------------------------------------ */
+
+static int failures = 0;
+
+/* ------------------------------------------------------------------------------ */
+
+static void check (int ok, const char *what)
+{
+  if (!ok)
+  {
+    fprintf(stderr, "Error: %s\n", what);
+    failures++;
+  }
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// counts the triangles of a csr on every triple of indices, O(size^3), and
+// the triangles and distinct neighbours (no self loops) of each index
+static long brute_force (csr_t *c, long *triangles, long *degrees)
+{
+  char *adjacent = (char *) calloc((size_t) c->size * c->size, sizeof(char));
+  long total = 0;
+
+  if (!adjacent)
+    return -1;
+
+  for (int i = 0; i < c->size; ++i)
+    for (size_t k = c->offsets[i]; k < c->offsets[i + 1]; ++k)
+      if (c->targets[k] != i)
+        adjacent[(size_t) i * c->size + c->targets[k]] = 1;
+
+  for (int i = 0; i < c->size; ++i)
+  {
+    triangles[i] = degrees[i] = 0;
+    for (int j = 0; j < c->size; ++j)
+      degrees[i] += adjacent[(size_t) i * c->size + j];
+  }
+
+  for (int i = 0; i < c->size; ++i)
+    for (int j = i + 1; j < c->size; ++j)
+      if (adjacent[(size_t) i * c->size + j])
+        for (int k = j + 1; k < c->size; ++k)
+          if (adjacent[(size_t) i * c->size + k] && adjacent[(size_t) j * c->size + k])
+          {
+            triangles[i]++;
+            triangles[j]++;
+            triangles[k]++;
+            total++;
+          }
+
+  free(adjacent);
+  return total;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// the petersen graph has girth 5: no triangles and no clustering at all
+static void check_petersen (void)
+{
+  FILE *input = fopen("petersen", "r");
+
+  check(input != NULL, "unable to open petersen");
+  if (!input)
+    return;
+
+  graph_t *g = read_graph("petersen", input, 0);
+
+  fclose(input);
+  check(g != NULL, "unable to read petersen");
+  if (!g)
+    return;
+
+  csr_t *c = freeze_graph(g);
+
+  check(c != NULL, "unable to freeze petersen");
+  if (c)
+  {
+    long triangles[c->size];
+    double coefficient[c->size];
+    int ok = count_triangles(c, triangles, 1) == 0 && local_clustering(c, coefficient, 1);
+
+    for (int i = 0; i < c->size && ok; ++i)
+      ok = !triangles[i] && coefficient[i] == 0;
+
+    check(ok, "petersen, triangles and local clustering");
+    check(global_clustering(c, 1) == 0, "petersen, global clustering");
+  }
+
+  csr_destroy(c);
+  destroy_graph(g);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// every thread count must agree with the brute force count, also through the
+// self loops and repeated edges the csr keeps
+static void check_random (void)
+{
+  graph_t *g = create_graph("random");
+  int src[EDGES], dst[EDGES];
+  uint64_t seed = 67;
+  int ok = g != NULL;
+
+  for (int i = 0; i < EDGES; ++i)
+  {
+    src[i] = (int) (bench_rand(&seed) % VERTICES);
+    dst[i] = (int) (bench_rand(&seed) % VERTICES);
+  }
+
+  ok = ok && graph_add_edges(g, src, dst, EDGES, BATCH_UNDIRECTED) >= 0;
+
+  csr_t *c = ok ? freeze_graph(g) : NULL;
+
+  check(c != NULL, "unable to build the random graph");
+  if (!c)
+  {
+    destroy_graph(g);
+    return;
+  }
+
+  long expected[c->size], degrees[c->size], triangles[c->size];
+  double coefficient[c->size];
+  long total = brute_force(c, expected, degrees);
+  long paths = 0;
+
+  check(total > 0, "random graph, brute force count");
+
+  for (int i = 0; i < c->size; ++i)
+    paths += degrees[i] * (degrees[i] - 1) / 2;
+
+  for (int threads = 1; threads <= MAX_THREADS && total > 0; threads *= 2)
+  {
+    char label[64];
+
+    snprintf(label, sizeof(label), "random graph, %d threads", threads);
+    ok = count_triangles(c, triangles, threads) == total && count_triangles(c, NULL, threads) == total &&
+         local_clustering(c, coefficient, threads);
+
+    for (int i = 0; i < c->size && ok; ++i)
+    {
+      double pairs = degrees[i] * (degrees[i] - 1) / 2.0;
+
+      ok = triangles[i] == expected[i] && fabs(coefficient[i] - (pairs ? expected[i] / pairs : 0)) < 1e-9;
+    }
+
+    ok = ok && fabs(global_clustering(c, threads) - 3.0 * total / paths) < 1e-9;
+    check(ok, label);
+  }
+
+  csr_destroy(c);
+  destroy_graph(g);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  check_petersen();
+  check_random();
+
+  if (!failures)
+    printf("triangles: ok\n");
+
+  return failures != 0;
+}
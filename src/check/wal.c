@@ -0,0 +1,273 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "wal.h"
+#include "bench/bench.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTICES 300
+#define EDGES 2000
+#define REMOVED 30
+#define TORN 3
+
+// ids and values with both signs, so the zigzag varints see negative numbers
+#define ID(i) (7 * (i) - 1000)
+#define VALUE(i) (1 - 3 * ID(i))
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct
+{
+  int id ;
+  double weight ;
+} target_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int failures = 0;
+
+/* ------------------------------------------------------------------------------ */
+
+static void check (int ok, const char *what)
+{
+  if (!ok)
+  {
+    fprintf(stderr, "Error: %s\n", what);
+    failures++;
+  }
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int compare_targets (const void *a, const void *b)
+{
+  const target_t *x = (const target_t *) a, *y = (const target_t *) b;
+
+  if (x->id != y->id)
+    return x->id < y->id ? -1 : 1;
+
+  return (x->weight > y->weight) - (x->weight < y->weight);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// the edges list of a vertex as (destination id, weight) pairs, sorted
+static target_t *targets (vertex_t *v)
+{
+  target_t *t = (target_t *) malloc((v->degree + 1) * sizeof(target_t));
+  edge_t *edge_it = v->edges;
+  int n = 0;
+
+  if (!t)
+    return NULL;
+
+  if (edge_it)
+    do
+    {
+      t[n].id = edge_it->vertex->id;
+      t[n++].weight = edge_it->weight;
+    }
+    while ((edge_it = edge_it->next) != v->edges && n < v->degree);
+
+  qsort(t, n, sizeof(target_t), compare_targets);
+  return t;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// compares two graphs vertex by vertex: the same id and value at each index
+// and the same edges, with their weights, in any order
+static int same_graph (graph_t *a, graph_t *b)
+{
+  int ok = a && b && a->size == b->size;
+
+  for (int i = 0; i < a->size && ok; ++i)
+  {
+    vertex_t *v1 = a->table[i], *v2 = b->table[i];
+
+    ok = v1->id == v2->id && v1->value == v2->value && v1->degree == v2->degree;
+
+    if (ok)
+    {
+      target_t *t1 = targets(v1), *t2 = targets(v2);
+
+      ok = t1 && t2;
+      for (int k = 0; k < v1->degree && ok; ++k)
+        ok = !compare_targets(t1 + k, t2 + k);
+      free(t1);
+      free(t2);
+    }
+  }
+
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// applies the same changes to every graph built with the same seed: vertices,
+// single and weighted edges, a batch and removals of edges and vertices
+static int populate (graph_t *g, uint64_t seed)
+{
+  int src[EDGES / 2], dst[EDGES / 2];
+  int ok = 1;
+
+  for (int i = 0; i < VERTICES && ok; ++i)
+    ok = add_vertex(g, VALUE(i), ID(i)) != NULL;
+
+  for (int i = 0; i < EDGES / 2 && ok; ++i)
+  {
+    vertex_t *v1 = g->table[bench_rand(&seed) % g->size];
+    vertex_t *v2 = g->table[bench_rand(&seed) % g->size];
+
+    if (bench_rand(&seed) % 3)
+      ok = add_edge(v1, v2);
+    else
+      ok = add_weighted_edge(v1, v2, 0.25 + (double) (bench_rand(&seed) % 1000) / 7);
+  }
+
+  for (int i = 0; i < EDGES / 2; ++i)
+  {
+    src[i] = ID((int) (bench_rand(&seed) % VERTICES));
+    dst[i] = ID((int) (bench_rand(&seed) % VERTICES));
+  }
+
+  ok = ok && graph_add_edges(g, src, dst, EDGES / 2, BATCH_UNDIRECTED) >= 0;
+
+  for (int i = 0; i < REMOVED && ok; ++i)
+  {
+    vertex_t *v = g->table[bench_rand(&seed) % g->size];
+
+    if (v->edges)
+      release_edge(g, remove_edge(v, v->edges->vertex));
+  }
+
+  // a removed vertex gives its index to the last one
+  for (int i = 0; i < REMOVED && ok; ++i)
+    release_vertex(g, remove_vertex(g, g->table[bench_rand(&seed) % g->size], 1));
+
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// replays a log into a new graph and compares it with the expected one
+static void check_log (const char *path, graph_t *expected, const char *what)
+{
+  graph_t *r = create_graph("replay");
+
+  check(r && wal_replay(path, r) > 0 && same_graph(expected, r), what);
+  destroy_graph(r);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// every change is replayed, also after a compaction and the appends that
+// follow it
+static void check_replay (void)
+{
+  char path[] = "/tmp/queue-wal-XXXXXX";
+  int fd = mkstemp(path);
+  graph_t *g = create_graph("wal");
+  wal_t *w = NULL;
+  int ok = fd >= 0 && g;
+
+  if (fd >= 0)
+    close(fd);
+
+  ok = ok && (w = wal_open(path, 0));
+  if (ok)
+  {
+    wal_attach(w, g);
+    ok = populate(g, 73);
+    wal_attach(NULL, g);
+  }
+
+  ok &= wal_close(w);
+  check(ok, "unable to build the logged graph");
+
+  if (ok)
+  {
+    check_log(path, g, "replay");
+
+    // the compacted log keeps the indices left by the removals
+    ok = (w = wal_open(path, 0)) && wal_compact(w, g);
+    check(ok, "unable to compact the log");
+    if (ok)
+      check_log(path, g, "replay, compacted");
+
+    if (w)
+    {
+      wal_attach(w, g);
+      for (int i = 0; i < REMOVED; ++i)
+        add_edge(g->table[i], g->table[g->size - 1 - i]);
+      release_vertex(g, remove_vertex(g, g->table[0], 1));
+      wal_attach(NULL, g);
+      check(wal_close(w), "unable to close the compacted log");
+      check_log(path, g, "replay, appended after compacting");
+    }
+  }
+
+  destroy_graph(g);
+  unlink(path);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// a crash in the middle of the last frame loses that frame and nothing else
+static void check_torn (void)
+{
+  char path[] = "/tmp/queue-wal-XXXXXX";
+  int fd = mkstemp(path);
+  graph_t *g = create_graph("wal"), *expected = create_graph("expected");
+  wal_t *w = NULL;
+  struct stat st;
+  int ok = fd >= 0 && g && expected && populate(expected, 79);
+
+  if (fd >= 0)
+    close(fd);
+
+  ok = ok && (w = wal_open(path, 0));
+  if (ok)
+  {
+    wal_attach(w, g);
+    ok = populate(g, 79) && wal_sync(w);
+
+    // the last frame, written by wal_close
+    for (int i = 0; i < REMOVED && ok; ++i)
+      ok = add_weighted_edge(g->table[i], g->table[i + 1], 0.5);
+    release_vertex(g, remove_vertex(g, g->table[0], 1));
+    wal_attach(NULL, g);
+  }
+
+  ok &= wal_close(w);
+  ok = ok && !stat(path, &st) && !truncate(path, st.st_size - TORN);
+  check(ok, "unable to tear the log");
+
+  if (ok)
+  {
+    check_log(path, expected, "replay, torn tail");
+
+    // wal_open cuts the torn frame off
+    ok = (w = wal_open(path, 0)) && wal_close(w);
+    check(ok, "unable to reopen the torn log");
+    check_log(path, expected, "replay, torn tail after wal_open");
+  }
+
+  destroy_graph(expected);
+  destroy_graph(g);
+  unlink(path);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int main (void)
+{
+  check_replay();
+  check_torn();
+
+  if (!failures)
+    printf("wal: ok\n");
+
+  return failures != 0;
+}
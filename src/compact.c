@@ -0,0 +1,174 @@
+#include "compact.h"
+
+/* ------------------------------------------------------------------------------ */
+
+static int compare_ints (const void *a, const void *b)
+{
+  int x = *(const int *) a, y = *(const int *) b;
+
+  return (x > y) - (x < y);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// appends a varint, returns the new end
+static inline unsigned char *put_varint (unsigned char *p, uint32_t x)
+{
+  while (x >= 0x80)
+  {
+    *(p++) = (unsigned char) (x | 0x80);
+    x >>= 7;
+  }
+
+  *(p++) = (unsigned char) x;
+  return p;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+compact_t *compress_graph (graph_t *g)
+{
+  if (!g)
+    return NULL;
+
+  int max = max_degree(g);
+  compact_t *c = (compact_t *) calloc(1, sizeof(compact_t));
+  int *list = (int *) malloc((max > 0 ? max : 1) * sizeof(int));
+  size_t capacity = 64;
+  edge_t *edge_it;
+
+  if (!c || !list)
+  {
+    free(c);
+    free(list);
+    return NULL;
+  }
+
+  c->size = g->size;
+  c->name = (char *) calloc(strlen(g->name) + 1, sizeof(char));
+  c->bases = (size_t *) malloc(((g->size >> COMPACT_BLOCK_BITS) + 1) * sizeof(size_t));
+  c->offsets = (uint32_t *) malloc((g->size + 1) * sizeof(uint32_t));
+  c->ids = (int *) malloc((g->size + 1) * sizeof(int));
+  c->values = (int *) malloc((g->size + 1) * sizeof(int));
+
+  for (int i = 0; i < g->size; ++i)
+    c->edges += g->table[i]->degree;
+
+  // starts at two bytes per edge, a varint takes at most 5
+  capacity += 2 * c->edges + COMPACT_PADDING;
+  c->data = (unsigned char *) malloc(capacity);
+
+  if (!c->name || !c->bases || !c->offsets || !c->ids || !c->values || !c->data)
+  {
+    free(list);
+    compact_destroy(c);
+    return NULL;
+  }
+
+  strcpy(c->name, g->name);
+
+  for (int i = 0; i < c->size; ++i)
+  {
+    vertex_t *v = g->table[i];
+    int degree = 0, last = i;
+
+    c->ids[i] = v->id;
+    c->values[i] = v->value;
+
+    if (!(i & ((1 << COMPACT_BLOCK_BITS) - 1))) // first list of a block
+      c->bases[i >> COMPACT_BLOCK_BITS] = c->bytes;
+    else if (c->bytes - c->bases[i >> COMPACT_BLOCK_BITS] > UINT32_MAX)
+    {
+      free(list);
+      compact_destroy(c);
+      return NULL;
+    }
+
+    c->offsets[i] = (uint32_t) (c->bytes - c->bases[i >> COMPACT_BLOCK_BITS]);
+
+    if ((edge_it = v->edges))
+      do
+        list[degree++] = edge_it->vertex->index;
+      while ((edge_it = edge_it->next) != v->edges);
+
+    qsort(list, degree, sizeof(int), compare_ints);
+
+    size_t need = c->bytes + 5 * (size_t) degree + COMPACT_PADDING; // worst case
+
+    if (need > capacity)
+    {
+      size_t grown = 2 * capacity > need ? 2 * capacity : need;
+      unsigned char *data = (unsigned char *) realloc(c->data, grown);
+
+      if (!data)
+      {
+        free(list);
+        compact_destroy(c);
+        return NULL;
+      }
+
+      c->data = data;
+      capacity = grown;
+    }
+
+    unsigned char *p = c->data + c->bytes;
+
+    for (int k = 0; k < degree; ++k)
+    {
+      int32_t gap = list[k] - last;
+
+      // the first gap can be negative, the others cannot (sorted list)
+      p = put_varint(p, k ? (uint32_t) gap : ((uint32_t) gap << 1) ^ (uint32_t) (gap >> 31));
+      last = list[k];
+    }
+
+    c->bytes = p - c->data;
+  }
+
+  // the end of the last list, in a block of its own if it starts one
+  if (!(c->size & ((1 << COMPACT_BLOCK_BITS) - 1)))
+    c->bases[c->size >> COMPACT_BLOCK_BITS] = c->bytes;
+  c->offsets[c->size] = (uint32_t) (c->bytes - c->bases[c->size >> COMPACT_BLOCK_BITS]);
+  free(list);
+
+  // gives the unused room back, keeping the padding
+  unsigned char *data = (unsigned char *) realloc(c->data, c->bytes + COMPACT_PADDING);
+
+  if (data)
+    c->data = data;
+
+  memset(c->data + c->bytes, 0, COMPACT_PADDING);
+
+  return c;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int compact_degree (const compact_t *c, int i)
+{
+  compact_iter_t iter = compact_iter(c, i);
+  int degree = 0;
+
+  // every number ends with a byte without the high bit
+  for (; iter.it < iter.end; ++iter.it)
+    degree += !(*iter.it & 0x80);
+
+  return degree;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int compact_destroy (compact_t *c)
+{
+  if (!c)
+    return 0;
+
+  free(c->bases);
+  free(c->offsets);
+  free(c->data);
+  free(c->ids);
+  free(c->values);
+  free(c->name);
+  free(c);
+  return 1;
+}
@@ -0,0 +1,196 @@
+#ifndef __COMPACT__
+#define __COMPACT__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "graph.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define COMPACT_PADDING 4
+#define COMPACT_BLOCK_BITS 10
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct compact_t compact_t ;
+typedef struct compact_iter_t compact_iter_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: compact (compressed adjacency)
+ * ------------------------------------------------------------------------------
+ * read only snapshot of a graph that keeps each neighbourhood as a sorted list
+ * of gaps encoded as varints (7 bits per byte, the high bit set on every byte
+ * but the last of a number). The first neighbour of the vertex i is stored as
+ * its distance to i (zigzag encoded, it can be negative) and every other one
+ * as its distance to the previous neighbour, so the lists of a graph with
+ * good locality (see reorder_graph) take about one byte per edge. The indices
+ * are the dense indices of the vertices, like in freeze_graph.
+ *
+ * The list of the vertex i starts at bases[i >> COMPACT_BLOCK_BITS] +
+ * offsets[i], so each vertex costs 4 bytes of offset instead of 8.
+ *
+ * bases: start of each block of 2^COMPACT_BLOCK_BITS lists in data
+ * offsets: start of each vertex list in its block (size + 1 entries)
+ * data: encoded lists, one after the other
+ * ids: vertex id of each index
+ * values: vertex value of each index
+ * name: graph name
+ * size: number of vertices
+ * edges: number of encoded neighbours
+ * bytes: size of data (COMPACT_PADDING more bytes are allocated, so the
+ * decoder can read a whole word at the end of the last list)
+ * ------------------------------------------------------------------------------ */
+
+struct compact_t
+{
+  size_t *bases ;
+  uint32_t *offsets ;
+  unsigned char *data ;
+  int *ids ;
+  int *values ;
+  char *name ;
+  int size ;
+  size_t edges ;
+  size_t bytes ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: compact iterator
+ * ------------------------------------------------------------------------------
+ * it: next byte to be decoded
+ * end: end of the list
+ * last: last decoded neighbour (the vertex itself before the first one)
+ * first: indicates if the next neighbour is the first one (1) or not (0)
+ * ------------------------------------------------------------------------------ */
+
+struct compact_iter_t
+{
+  const unsigned char *it, *end ;
+  int last ;
+  int first ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: compress_graph
+ * ------------------------------------------------------------------------------
+ * builds a compressed snapshot of the graph. The neighbours of each vertex
+ * are sorted by dense index (repeated edges are kept). Later changes to the
+ * graph do not affect the snapshot.
+ *
+ * g: graph to be compressed
+ *
+ * returns: pointer to the snapshot or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+compact_t *compress_graph (graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: compact_degree
+ * ------------------------------------------------------------------------------
+ * counts the neighbours of a vertex (one per byte without the high bit)
+ *
+ * c: snapshot of the vertex
+ * i: vertex index
+ *
+ * returns: number of neighbours of the vertex
+ * ------------------------------------------------------------------------------ */
+
+int compact_degree (const compact_t *c, int i) ;
+
+/* ------------------------------------------------------------------------------
+ * function: compact_iter
+ * ------------------------------------------------------------------------------
+ * creates an iterator that decodes the neighbourhood of a vertex, in
+ * increasing index order
+ *
+ * c: snapshot of the vertex
+ * i: vertex index
+ *
+ * returns: iterator placed before the first neighbour
+ * ------------------------------------------------------------------------------ */
+
+static inline compact_iter_t compact_iter (const compact_t *c, int i)
+{
+  compact_iter_t iter = { c->data + c->bases[i >> COMPACT_BLOCK_BITS] + c->offsets[i],
+                          c->data + c->bases[(i + 1) >> COMPACT_BLOCK_BITS] + c->offsets[i + 1], i, 1 };
+
+  return iter;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: compact_next
+ * ------------------------------------------------------------------------------
+ * decodes the next neighbour
+ *
+ * iter: iterator created by compact_iter
+ * j: receives the index of the neighbour
+ *
+ * returns: 1 if there was a neighbour or 0 if the neighbourhood has ended
+ * ------------------------------------------------------------------------------ */
+
+static inline int compact_next (compact_iter_t *iter, int *j)
+{
+  if (iter->it == iter->end)
+    return 0;
+
+  uint32_t x;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  // reads 4 bytes at once (data is padded), the first byte without the high
+  // bit ends the number, so varints of 1 to 4 bytes take no branch
+  uint32_t word, stops;
+
+  memcpy(&word, iter->it, sizeof(word));
+  stops = ~word & 0x80808080u;
+
+  if (stops)
+  {
+    int length = (__builtin_ctz(stops) + 1) >> 3;
+
+    x = (word & 0x7f) | ((word >> 1) & 0x3f80) | ((word >> 2) & 0x1fc000) | ((word >> 3) & 0xfe00000);
+    x &= 0x0fffffffu >> (28 - 7 * length);
+    iter->it += length;
+  }
+  else
+#endif
+  {
+    int shift = 0;
+    uint32_t byte;
+
+    x = 0;
+    do
+    {
+      byte = *(iter->it++);
+      x |= (byte & 0x7f) << shift;
+      shift += 7;
+    }
+    while (byte & 0x80);
+  }
+
+  if (iter->first) // zigzag: 0, -1, 1, -2, ... are 0, 1, 2, 3, ...
+  {
+    iter->last += (int) ((x >> 1) ^ -(x & 1));
+    iter->first = 0;
+  }
+  else
+    iter->last += (int) x;
+
+  *j = iter->last;
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: compact_destroy
+ * ------------------------------------------------------------------------------
+ * frees a snapshot
+ *
+ * c: snapshot to be freed
+ *
+ * returns: 0 if c is NULL or 1 if it was freed
+ * ------------------------------------------------------------------------------ */
+
+int compact_destroy (compact_t *c) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,400 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "csr.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define CSR_MAGIC "QGRAPHB"
+#define CSR_VERSION 1
+#define CSR_BYTE_ORDER 0x01020304
+
+/* ------------------------------------------------------------------------------ */
+
+// header of the binary format, the positions are byte offsets in the file
+typedef struct csr_header_t
+{
+  char magic[8] ;
+  uint32_t version ;
+  uint32_t byte_order ;
+  uint32_t offset_size ;
+  uint32_t int_size ;
+  uint64_t size, edges ;
+  uint64_t offsets, targets, ids, values, order, name ;
+  uint64_t file_size ;
+} csr_header_t ;
+
+typedef struct id_pair_t
+{
+  int id ;
+  int index ;
+} id_pair_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int compare_id_pairs (const void *a, const void *b)
+{
+  int id1 = ((const id_pair_t *) a)->id, id2 = ((const id_pair_t *) b)->id;
+
+  return (id1 > id2) - (id1 < id2);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+csr_t *freeze_graph (graph_t *g)
+{
+  if (!g)
+    return NULL;
+
+  csr_t *c = (csr_t *) calloc(1, sizeof(csr_t));
+  id_pair_t *pairs = (id_pair_t *) malloc((g->size + 1) * sizeof(id_pair_t));
+  edge_t *edge_it;
+  int i;
+
+  if (!c || !pairs)
+  {
+    free(c);
+    free(pairs);
+    return NULL;
+  }
+
+  c->size = g->size;
+  c->name = (char *) calloc(strlen(g->name) + 1, sizeof(char));
+  c->offsets = (size_t *) malloc((g->size + 1) * sizeof(size_t));
+  c->ids = (int *) malloc((g->size + 1) * sizeof(int));
+  c->values = (int *) malloc((g->size + 1) * sizeof(int));
+  c->order = (int *) malloc((g->size + 1) * sizeof(int));
+
+  if (!c->name || !c->offsets || !c->ids || !c->values || !c->order)
+  {
+    free(pairs);
+    csr_destroy(c);
+    return NULL;
+  }
+
+  strcpy(c->name, g->name);
+  c->offsets[0] = 0;
+
+  // first pass: offsets, the csr index is the vertex dense index
+  for (i = 0; i < c->size; ++i)
+  {
+    c->ids[i] = g->table[i]->id;
+    c->values[i] = g->table[i]->value;
+    c->offsets[i + 1] = c->offsets[i] + g->table[i]->degree;
+    pairs[i].id = g->table[i]->id;
+    pairs[i].index = i;
+  }
+
+  c->edges = c->offsets[c->size];
+
+  if (!(c->targets = (int *) malloc((c->edges + 1) * sizeof(int))))
+  {
+    free(pairs);
+    csr_destroy(c);
+    return NULL;
+  }
+
+  // second pass: neighbour indices, in the order of the edges lists
+  for (i = 0; i < c->size; ++i)
+  {
+    size_t pos = c->offsets[i];
+
+    if ((edge_it = g->table[i]->edges))
+      do
+        c->targets[pos++] = edge_it->vertex->index;
+      while ((edge_it = edge_it->next) != g->table[i]->edges);
+  }
+
+  qsort(pairs, c->size, sizeof(id_pair_t), compare_id_pairs);
+  for (i = 0; i < c->size; ++i)
+    c->order[i] = pairs[i].index;
+
+  free(pairs);
+  return c;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+csr_t *csr_transpose (csr_t *c)
+{
+  if (!c)
+    return NULL;
+
+  csr_t *t = (csr_t *) calloc(1, sizeof(csr_t));
+
+  if (!t)
+    return NULL;
+
+  t->size = c->size;
+  t->edges = c->edges;
+  t->name = (char *) calloc(strlen(c->name) + 1, sizeof(char));
+  t->offsets = (size_t *) calloc(c->size + 1, sizeof(size_t));
+  t->targets = (int *) malloc((c->edges + 1) * sizeof(int));
+  t->ids = (int *) malloc((c->size + 1) * sizeof(int));
+  t->values = (int *) malloc((c->size + 1) * sizeof(int));
+  t->order = (int *) malloc((c->size + 1) * sizeof(int));
+
+  if (!t->name || !t->offsets || !t->targets || !t->ids || !t->values || !t->order)
+  {
+    csr_destroy(t);
+    return NULL;
+  }
+
+  strcpy(t->name, c->name);
+  memcpy(t->ids, c->ids, c->size * sizeof(int));
+  memcpy(t->values, c->values, c->size * sizeof(int));
+  memcpy(t->order, c->order, c->size * sizeof(int));
+
+  // counts the in-degrees, then turns them into offsets
+  for (size_t e = 0; e < c->edges; ++e)
+    t->offsets[c->targets[e] + 1]++;
+  for (int i = 0; i < c->size; ++i)
+    t->offsets[i + 1] += t->offsets[i];
+
+  // sources are visited in order, so every in-neighbourhood ends up sorted
+  for (int i = 0; i < c->size; ++i)
+    for (size_t e = c->offsets[i]; e < c->offsets[i + 1]; ++e)
+      t->targets[t->offsets[c->targets[e]]++] = i;
+
+  // the fill moved every offset to the start of the next vertex
+  memmove(t->offsets + 1, t->offsets, c->size * sizeof(size_t));
+  t->offsets[0] = 0;
+
+  return t;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int csr_search (csr_t *c, int id)
+{
+  if (!c)
+    return -1;
+
+  int low = 0, high = c->size - 1;
+
+  while (low <= high)
+  {
+    int mid = low + (high - low) / 2;
+    int mid_id = c->ids[c->order[mid]];
+
+    if (mid_id == id) // if the vertex has that id
+      return c->order[mid];
+
+    if (mid_id < id)
+      low = mid + 1;
+    else
+      high = mid - 1;
+  }
+
+  return -1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+csr_t *csr_write (csr_t *c, FILE *output, int is_directed)
+{
+  if (!c || !output)
+    return NULL;
+
+  for (int i = 0; i < c->size; ++i)
+  {
+    csr_iter_t iter = csr_iter(c, i);
+    int j;
+
+    if (!csr_degree(c, i))
+      fprintf(output, "%d\n", c->ids[i]);
+
+    while (csr_next(&iter, &j))
+      // the vertices before i were already written
+      if (is_directed || j >= i)
+        fprintf(output, "%d %d\n", c->ids[i], c->ids[j]);
+  }
+
+  return c;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static inline uint64_t align8 (uint64_t pos)
+{
+  return (pos + 7) & ~(uint64_t) 7;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// fills the header fields and the section positions (each section is
+// aligned to 8 bytes), the layout only depends on the sizes
+static void csr_layout (csr_header_t *h, uint64_t size, uint64_t edges, uint64_t name_length)
+{
+  memset(h, 0, sizeof(csr_header_t));
+  memcpy(h->magic, CSR_MAGIC, sizeof(h->magic));
+  h->version = CSR_VERSION;
+  h->byte_order = CSR_BYTE_ORDER;
+  h->offset_size = sizeof(size_t);
+  h->int_size = sizeof(int);
+  h->size = size;
+  h->edges = edges;
+
+  h->offsets = align8(sizeof(csr_header_t));
+  h->targets = align8(h->offsets + (size + 1) * sizeof(size_t));
+  h->ids = align8(h->targets + edges * sizeof(int));
+  h->values = align8(h->ids + size * sizeof(int));
+  h->order = align8(h->values + size * sizeof(int));
+  h->name = align8(h->order + size * sizeof(int));
+  h->file_size = h->name + name_length + 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void write_section (writer_t *w, uint64_t *pos, uint64_t start, const void *data, uint64_t size)
+{
+  static const char padding[8] = { 0 };
+
+  writer_bytes(w, padding, start - *pos);
+  writer_bytes(w, data, size);
+  *pos = start + size;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+csr_t *csr_write_binary (csr_t *c, FILE *output)
+{
+  if (!c || !output)
+    return NULL;
+
+  csr_header_t h;
+  writer_t w;
+  uint64_t pos = sizeof(csr_header_t);
+
+  csr_layout(&h, c->size, c->edges, strlen(c->name));
+
+  if (!writer_init(&w, output))
+    return NULL;
+
+  writer_bytes(&w, &h, sizeof(csr_header_t));
+  write_section(&w, &pos, h.offsets, c->offsets, (c->size + 1) * sizeof(size_t));
+  write_section(&w, &pos, h.targets, c->targets, c->edges * sizeof(int));
+  write_section(&w, &pos, h.ids, c->ids, c->size * sizeof(int));
+  write_section(&w, &pos, h.values, c->values, c->size * sizeof(int));
+  write_section(&w, &pos, h.order, c->order, c->size * sizeof(int));
+  write_section(&w, &pos, h.name, c->name, strlen(c->name) + 1);
+
+  return writer_close(&w) ? c : NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+graph_t *write_graph_binary (graph_t *g, FILE *output)
+{
+  if (!g || !output)
+    return NULL;
+
+  csr_t *c = freeze_graph(g);
+
+  if (!c)
+    return NULL;
+
+  if (!csr_write_binary(c, output))
+    g = NULL;
+
+  csr_destroy(c);
+  return g;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// verifies that every section of a layout ends inside a file of the given size
+static int csr_fits (const csr_header_t *h, uint64_t file_size)
+{
+  return h->offsets + (h->size + 1) * sizeof(size_t) <= file_size && h->targets + h->edges * sizeof(int) <= file_size &&
+         h->ids + h->size * sizeof(int) <= file_size && h->values + h->size * sizeof(int) <= file_size &&
+         h->order + h->size * sizeof(int) <= file_size && h->name < file_size;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+csr_t *csr_map (const char *path)
+{
+  if (!path)
+    return NULL;
+
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  csr_header_t *h, expected;
+  csr_t *c = NULL;
+  void *map;
+
+  if (fd < 0)
+    return NULL;
+
+  if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(csr_header_t))
+  {
+    close(fd);
+    return NULL;
+  }
+
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file open
+
+  if (map == MAP_FAILED)
+    return NULL;
+
+  h = (csr_header_t *) map;
+
+  // the header must describe exactly the layout written by csr_write_binary.
+  // The bounds come first, so the sums of csr_layout cannot overflow, and no
+  // section is read before it is known to end inside the file
+  if (h->size <= 2147483647ULL && h->edges <= (uint64_t) st.st_size / sizeof(int) &&
+      h->file_size == (uint64_t) st.st_size && h->name < h->file_size)
+  {
+    csr_layout(&expected, h->size, h->edges, h->file_size - h->name - 1);
+
+    if (!memcmp(h, &expected, sizeof(csr_header_t)) && csr_fits(&expected, st.st_size) &&
+        ((char *) map)[h->file_size - 1] == '\0' && ((size_t *) ((char *) map + h->offsets))[h->size] == h->edges)
+      c = (csr_t *) calloc(1, sizeof(csr_t));
+  }
+
+  if (!c)
+  {
+    munmap(map, st.st_size);
+    return NULL;
+  }
+
+  c->offsets = (size_t *) ((char *) map + h->offsets);
+  c->targets = (int *) ((char *) map + h->targets);
+  c->ids = (int *) ((char *) map + h->ids);
+  c->values = (int *) ((char *) map + h->values);
+  c->order = (int *) ((char *) map + h->order);
+  c->name = (char *) map + h->name;
+  c->size = (int) h->size;
+  c->edges = h->edges;
+  c->map = map;
+  c->map_size = st.st_size;
+
+  return c;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int csr_destroy (csr_t *c)
+{
+  if (!c)
+    return 0;
+
+  if (c->map) // the arrays live in the mapping
+  {
+    munmap(c->map, c->map_size);
+    free(c);
+    return 1;
+  }
+
+  free(c->offsets);
+  free(c->targets);
+  free(c->ids);
+  free(c->values);
+  free(c->order);
+  free(c->name);
+  free(c);
+  return 1;
+}
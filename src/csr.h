@@ -0,0 +1,228 @@
+#ifndef __CSR__
+#define __CSR__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "graph.h"
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct csr_t csr_t ;
+typedef struct csr_iter_t csr_iter_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: csr (compressed sparse row)
+ * ------------------------------------------------------------------------------
+ * read only snapshot of a graph. The vertices get dense indices from 0 to
+ * size - 1 and the neighbours of the vertex i are the indices stored in
+ * targets[offsets[i]] .. targets[offsets[i + 1] - 1], in the same order as
+ * its edges list.
+ *
+ * offsets: start of each vertex neighbourhood in targets (size + 1 entries)
+ * targets: neighbour indices of every vertex, one after the other
+ * ids: vertex id of each index
+ * values: vertex value of each index
+ * order: indices sorted by vertex id (used to find an index from an id)
+ * name: graph name
+ * map: mapped binary file holding all the arrays (NULL if they are on the heap)
+ * map_size: size of the mapping
+ * size: number of vertices
+ * edges: number of entries in targets
+ * ------------------------------------------------------------------------------ */
+
+struct csr_t
+{
+  size_t *offsets ;
+  int *targets ;
+  int *ids ;
+  int *values ;
+  int *order ;
+  char *name ;
+  void *map ;
+  size_t map_size ;
+  int size ;
+  size_t edges ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: csr iterator
+ * ------------------------------------------------------------------------------
+ * it: next neighbour to be visited
+ * end: end of the neighbourhood
+ * ------------------------------------------------------------------------------ */
+
+struct csr_iter_t
+{
+  const int *it, *end ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: freeze_graph
+ * ------------------------------------------------------------------------------
+ * builds a csr snapshot of the graph. The csr indices are the dense indices
+ * of the vertices (v->index). Later changes to the graph do not affect the
+ * snapshot.
+ *
+ * g: graph to be frozen
+ *
+ * returns: pointer to the csr or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+csr_t *freeze_graph (graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: csr_transpose
+ * ------------------------------------------------------------------------------
+ * builds the csr with every edge reversed (the in-edges of each vertex). The
+ * indices, ids and values are the same of the original csr.
+ *
+ * c: csr to be transposed
+ *
+ * returns: pointer to the transposed csr or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+csr_t *csr_transpose (csr_t *c) ;
+
+/* ------------------------------------------------------------------------------
+ * function: csr_search
+ * ------------------------------------------------------------------------------
+ * searches for the index of a vertex id (binary search over order)
+ *
+ * c: csr in which the id will be searched
+ * id: vertex id to be found
+ *
+ * returns: index of the vertex or -1 if not found
+ * ------------------------------------------------------------------------------ */
+
+int csr_search (csr_t *c, int id) ;
+
+/* ------------------------------------------------------------------------------
+ * function: csr_degree
+ * ------------------------------------------------------------------------------
+ * c: csr of the vertex
+ * i: vertex index
+ *
+ * returns: number of neighbours of the vertex
+ * ------------------------------------------------------------------------------ */
+
+static inline int csr_degree (const csr_t *c, int i)
+{
+  return (int) (c->offsets[i + 1] - c->offsets[i]);
+}
+
+/* ------------------------------------------------------------------------------
+ * function: csr_iter
+ * ------------------------------------------------------------------------------
+ * creates an iterator over the neighbourhood of a vertex
+ *
+ * c: csr of the vertex
+ * i: vertex index
+ *
+ * returns: the iterator
+ * ------------------------------------------------------------------------------ */
+
+static inline csr_iter_t csr_iter (const csr_t *c, int i)
+{
+  csr_iter_t iter = { c->targets + c->offsets[i], c->targets + c->offsets[i + 1] };
+
+  return iter;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: csr_next
+ * ------------------------------------------------------------------------------
+ * moves the iterator to the next neighbour
+ *
+ * iter: iterator created by csr_iter
+ * j: receives the index of the neighbour
+ *
+ * returns: 1 if there was a neighbour or 0 if the neighbourhood has ended
+ * ------------------------------------------------------------------------------ */
+
+static inline int csr_next (csr_iter_t *iter, int *j)
+{
+  if (iter->it == iter->end)
+    return 0;
+
+  *j = *(iter->it++);
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------
+ * function: csr_write
+ * ------------------------------------------------------------------------------
+ * writes a csr in the same format used in write_graph, in the order of the
+ * dense indices. While no vertex was removed from the graph and it was not
+ * relabeled (relabel_graph), the dense indices follow g->vertices and the
+ * output of a frozen graph matches the output of the graph itself. After
+ * either of them it has the same lines in another order, and an undirected
+ * edge may be written as "j i" instead of "i j".
+ *
+ * c: csr that will be written
+ * output: output in which the csr will be written
+ * is_directed: indicates if the graph is directed (1) or not (0)
+ *
+ * returns: pointer to the written csr or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+csr_t *csr_write (csr_t *c, FILE *output, int is_directed) ;
+
+/* ------------------------------------------------------------------------------
+ * function: csr_write_binary
+ * ------------------------------------------------------------------------------
+ * writes a csr in the binary format: a versioned header followed by the
+ * offsets, targets, ids, values and order arrays and the graph name, each one
+ * aligned to 8 bytes and stored as they are in memory (native byte order)
+ *
+ * c: csr that will be written
+ * output: output in which the csr will be written
+ *
+ * returns: pointer to the written csr or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+csr_t *csr_write_binary (csr_t *c, FILE *output) ;
+
+/* ------------------------------------------------------------------------------
+ * function: write_graph_binary
+ * ------------------------------------------------------------------------------
+ * writes a graph in the binary format (see csr_write_binary)
+ *
+ * g: graph that will be written
+ * output: output in which the graph will be written
+ *
+ * returns: pointer to the written graph or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+graph_t *write_graph_binary (graph_t *g, FILE *output) ;
+
+/* ------------------------------------------------------------------------------
+ * function: csr_map
+ * ------------------------------------------------------------------------------
+ * maps a file written by csr_write_binary. The arrays of the returned csr
+ * point straight into the mapping, so nothing is parsed or copied and the
+ * pages are only read when they are used. The header and the bounds of every
+ * section are verified, the contents of the arrays are not. The file must not
+ * be changed while it is mapped.
+ *
+ * path: path of the file
+ *
+ * returns: pointer to the csr or NULL if the file is not a valid binary graph
+ * ------------------------------------------------------------------------------ */
+
+csr_t *csr_map (const char *path) ;
+
+/* ------------------------------------------------------------------------------
+ * function: csr_destroy
+ * ------------------------------------------------------------------------------
+ * deallocate all the memory used in a csr (or unmaps its file)
+ *
+ * c: csr to have the memory deallocated
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int csr_destroy (csr_t *c) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -1,82 +1,898 @@
 #include "graph.h"
+#include "wal.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define VERTEX_SLAB_ITEMS 256
+#define EDGE_SLAB_ITEMS 1024
+#define STRIPE_ALIGNMENT 64
+#define RADIX_MIN 4096
+
+/* ------------------------------------------------------------------------------ */
+
+static inline uint64_t edge_key (vertex_t *v1, vertex_t *v2)
+{
+  return ((uint64_t) (uint32_t) v1->id << 32) | (uint32_t) v2->id;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// stripe that owns a vertex id (the ids are mixed, so consecutive ids go to
+// different stripes)
+static inline graph_stripe_t *stripe_of (graph_t *g, int id)
+{
+  return &(g->stripes[(((uint32_t) id * 2654435761u) >> 16) & (g->stripe_count - 1)]);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static inline void lock_stripe (graph_t *g, graph_stripe_t *s)
+{
+  if (g->flags & GRAPH_CONCURRENT)
+    pthread_mutex_lock(&(s->lock));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static inline void unlock_stripe (graph_t *g, graph_stripe_t *s)
+{
+  if (g->flags & GRAPH_CONCURRENT)
+    pthread_mutex_unlock(&(s->lock));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// locks two stripes in address order (the same order as lock_all), so two
+// threads never wait for each other
+static void lock_pair (graph_t *g, graph_stripe_t *s1, graph_stripe_t *s2)
+{
+  if (s2 < s1)
+  {
+    graph_stripe_t *aux = s1;
+
+    s1 = s2;
+    s2 = aux;
+  }
+
+  lock_stripe(g, s1);
+  if (s2 != s1)
+    lock_stripe(g, s2);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void unlock_pair (graph_t *g, graph_stripe_t *s1, graph_stripe_t *s2)
+{
+  unlock_stripe(g, s1);
+  if (s2 != s1)
+    unlock_stripe(g, s2);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// gives the whole graph to the calling thread
+static void lock_all (graph_t *g)
+{
+  for (int i = 0; i < g->stripe_count; ++i)
+    lock_stripe(g, &(g->stripes[i]));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void unlock_all (graph_t *g)
+{
+  for (int i = g->stripe_count - 1; i >= 0; --i)
+    unlock_stripe(g, &(g->stripes[i]));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// the dense table, the vertices list and the version are shared by every
+// stripe (the graph lock is always taken after the stripes)
+static inline void lock_table (graph_t *g)
+{
+  if (g->flags & GRAPH_CONCURRENT)
+    pthread_mutex_lock(&(g->lock));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static inline void unlock_table (graph_t *g)
+{
+  if (g->flags & GRAPH_CONCURRENT)
+    pthread_mutex_unlock(&(g->lock));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// drops the current version after an allocation error, the next
+// graph_snapshot builds it again (the table must be held)
+static void lose_version (graph_t *g)
+{
+  version_release(g->version);
+  g->version = NULL;
+  g->version_edges = 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// records an edge from v1 to v2 that was added (or removed) in the current
+// version, if the graph keeps one (the table must be held)
+static void track_edge (graph_t *g, vertex_t *v1, vertex_t *v2, int added)
+{
+  if (!g->version)
+    return;
+
+  snapshot_vertex_t *v = version_vertex(&(g->version), v1->id);
+
+  if (!v || !(added ? version_link(v, v2->id) : version_unlink(v, v2->id)))
+    lose_version(g);
+  else
+    g->version_edges += added ? 1 : -1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// makes room in the degree histogram of a stripe for a given degree
+static int reserve_degree (graph_stripe_t *s, int degree)
+{
+  if (degree < s->histogram_size)
+    return 1;
+
+  int size = s->histogram_size ? s->histogram_size : 16;
+
+  while (size <= degree)
+    size *= 2;
+
+  int *histogram = (int *) realloc(s->histogram, size * sizeof(int));
+
+  if (!histogram)
+    return 0;
+
+  memset(histogram + s->histogram_size, 0, (size - s->histogram_size) * sizeof(int));
+  s->histogram = histogram;
+  s->histogram_size = size;
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// changes the degree of v, keeping the edge count and the degree histogram of
+// its stripe up to date (the histogram must have room for the new degree)
+static inline void set_degree (graph_stripe_t *s, vertex_t *v, int degree)
+{
+  s->histogram[v->degree]--;
+  s->histogram[degree]++;
+  s->edges += degree - v->degree;
+  v->degree = degree;
+
+  if (degree > s->max_degree)
+    s->max_degree = degree;
+
+  while (s->max_degree > 0 && !s->histogram[s->max_degree])
+    s->max_degree--;
+
+  // min_degree is only a lower bound, min_degree() fixes it
+  if (degree < s->min_degree)
+    s->min_degree = degree;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// search_edge without the timing, for the callers that hold a stripe
+static edge_t *scan_edges (edge_t *e, vertex_t *v)
+{
+  edge_t *edge_it = e;
+
+  if (edge_it)
+    do
+    {
+      TRACE_COUNT(TRACE_HOPS, 1);
+
+      if (edge_it->vertex == v) // if the edge is found
+        return edge_it;
+    }
+    while ((edge_it = edge_it->next) != e);
+
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// finds an edge from v1 to v2 (s is the stripe of v1)
+static inline edge_t *find_edge (graph_stripe_t *s, vertex_t *v1, vertex_t *v2)
+{
+  if (v1->graph->flags & GRAPH_NO_EDGE_SET)
+    return scan_edges(v1->edges, v2);
+
+  return (edge_t *) hash_search(&(s->edge_set), edge_key(v1, v2));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// removes a known edge from the edges list of v1, keeping the edge set, the
+// in-edges list of the other end and the version up to date (the table must
+// be held if the graph is versioned)
+static edge_t *unlink_edge (vertex_t *v1, edge_t *e)
+{
+  graph_t *g = v1->graph;
+  graph_stripe_t *s = stripe_of(g, v1->id);
+  vertex_t *v2 = e->vertex;
+
+  queue_remove(&(v1->edge_list), (queue_t *) e);
+  set_degree(s, v1, v1->degree - 1);
+  track_edge(g, v1, v2, 0);
+
+  if (v1 == v2)
+    s->self_loops--;
+
+  if (!(g->flags & GRAPH_NO_EDGE_SET))
+  {
+    if (hash_search(&(s->edge_set), edge_key(v1, v2)) == e)
+    {
+      edge_t *repeated;
+
+      hash_remove(&(s->edge_set), edge_key(v1, v2));
+
+      // indexes a repeated edge of the same pair, if there is one left
+      if (s->parallel_edges && (repeated = scan_edges(v1->edges, v2)))
+      {
+        hash_insert(&(s->edge_set), edge_key(v1, v2), repeated);
+        s->parallel_edges--;
+      }
+    }
+    else // e was a repeated edge, which is not in the set
+      s->parallel_edges--;
+  }
+
+  if (e->twin) // drops the matching in-edge
+  {
+    queue_remove(&(v2->in_edge_list), (queue_t *) e->twin);
+    pool_free(&(g->edge_pool), e->twin);
+    e->twin = NULL;
+  }
+
+  return e;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// inserts a vertex (the stripe s of the id must be held)
+static vertex_t *insert_vertex (graph_t *g, graph_stripe_t *s, int value, int id)
+{
+  if (!reserve_degree(s, 0))
+    return NULL;
+
+  vertex_t *new_vertex = (vertex_t *) pool_alloc(&(g->vertex_pool));
+
+  if (!new_vertex)
+    return NULL;
+
+  TRACE_COUNT(TRACE_VERTICES, 1);
+  queue_init(&(new_vertex->edge_list));
+  queue_init(&(new_vertex->in_edge_list));
+  new_vertex->graph = g;
+  new_vertex->degree = 0;
+  new_vertex->value = value;
+  new_vertex->id = id;
+
+  // indexed first, so nothing is linked to the graph if it fails
+  if (!hash_insert(&(s->index), (uint32_t) id, new_vertex))
+  {
+    pool_free(&(g->vertex_pool), new_vertex);
+    return NULL;
+  }
+
+  lock_table(g);
+
+  if (g->size == g->capacity) // grows the dense table
+  {
+    int capacity = g->capacity ? 2 * g->capacity : 16;
+    vertex_t **table = (vertex_t **) realloc(g->table, capacity * sizeof(vertex_t *));
+
+    if (!table)
+    {
+      unlock_table(g);
+      hash_remove(&(s->index), (uint32_t) id);
+      pool_free(&(g->vertex_pool), new_vertex);
+      return NULL;
+    }
+
+    g->table = table;
+    g->capacity = capacity;
+  }
+
+  new_vertex->index = g->size;
+  g->table[g->size++] = new_vertex;
+  queue_append(&(g->vertex_list), (queue_t *) new_vertex);
+
+  if (g->version && !version_insert(&(g->version), id, value))
+    lose_version(g);
+
+  // logged under the table lock, so the log keeps the order of the indices
+  if (g->log)
+    wal_append(g->log, WAL_ADD_VERTEX, id, value, 0);
+
+  unlock_table(g);
+
+  s->histogram[0]++;
+  s->size++;
+  s->min_degree = 0;
+  return new_vertex;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// finds a vertex by id or inserts it (value = id), like in read_graph (the
+// graph must be held)
+static vertex_t *fetch_vertex (graph_t *g, int id)
+{
+  graph_stripe_t *s = stripe_of(g, id);
+  vertex_t *v = (vertex_t *) hash_search(&(s->index), (uint32_t) id);
+
+  return v ? v : insert_vertex(g, s, id, id);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// inserts an edge (the stripes of v1 and v2 must be held)
+static int insert_edge (graph_stripe_t *s, vertex_t *v1, vertex_t *v2, double weight)
+{
+  graph_t *g = v1->graph;
+
+  if (!reserve_degree(s, v1->degree + 1))
+    return 0;
+
+  edge_t *new_edge = (edge_t *) pool_alloc(&(g->edge_pool));
+
+  if (!new_edge)
+    return 0;
+
+  new_edge->vertex = v2;
+  new_edge->next = new_edge->prev = NULL;
+  new_edge->twin = NULL;
+  new_edge->weight = weight;
+
+  if ((g->flags & GRAPH_IN_EDGES) && !(new_edge->twin = (edge_t *) pool_alloc(&(g->edge_pool))))
+  {
+    pool_free(&(g->edge_pool), new_edge);
+    return 0;
+  }
+
+  if (!(g->flags & GRAPH_NO_EDGE_SET))
+  {
+    // the set keeps the first edge of each pair, repeated ones are counted
+    if (hash_search(&(s->edge_set), edge_key(v1, v2)))
+      s->parallel_edges++;
+    else if (!hash_insert(&(s->edge_set), edge_key(v1, v2), new_edge))
+    {
+      pool_free(&(g->edge_pool), new_edge->twin);
+      pool_free(&(g->edge_pool), new_edge);
+      return 0;
+    }
+  }
+
+  TRACE_COUNT(TRACE_EDGES, new_edge->twin ? 2 : 1);
+
+  // inserts v2 in v1
+  queue_append(&(v1->edge_list), (queue_t *) new_edge);
+  set_degree(s, v1, v1->degree + 1);
+
+  if (v1 == v2)
+    s->self_loops++;
+
+  if (g->versioned)
+  {
+    lock_table(g);
+    track_edge(g, v1, v2, 1);
+    unlock_table(g);
+  }
+
+  if (new_edge->twin) // inserts v1 in the in-edges of v2
+  {
+    new_edge->twin->vertex = v1;
+    new_edge->twin->twin = new_edge;
+    new_edge->twin->weight = weight;
+    queue_append(&(v2->in_edge_list), (queue_t *) new_edge->twin);
+  }
+
+  return 1;
+}
 
 /* ------------------------------------------------------------------------------ */
 
 graph_t *create_graph (char *name)
 {
-  graph_t *g = (graph_t *) malloc(sizeof(graph_t));
+  return create_graph_flags(name, 0);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+graph_t *create_graph_flags (char *name, int flags)
+{
+  TRACE_BEGIN();
+  graph_t *g = (graph_t *) malloc(sizeof(graph_t));
+
+  if (!g)
+    return NULL;
+
+  if (flags & GRAPH_CONCURRENT) // malloc is already thread safe
+    flags |= GRAPH_NO_POOL;
+
+  int pooled = !(flags & GRAPH_NO_POOL);
+
+  g->stripe_count = (flags & GRAPH_CONCURRENT) ? GRAPH_STRIPES : 1;
+  g->stripes = (graph_stripe_t *) aligned_alloc(STRIPE_ALIGNMENT, g->stripe_count * sizeof(graph_stripe_t));
+
+  if (!g->stripes)
+  {
+    free(g);
+    return NULL;
+  }
+
+  for (int i = 0; i < g->stripe_count; ++i)
+  {
+    graph_stripe_t *s = &(g->stripes[i]);
+
+    hash_init(&(s->index));
+    hash_init(&(s->edge_set));
+    s->size = 0;
+    s->parallel_edges = 0;
+    s->edges = 0;
+    s->self_loops = 0;
+    s->histogram = NULL;
+    s->histogram_size = 0;
+    s->min_degree = s->max_degree = 0;
+
+    if (flags & GRAPH_CONCURRENT)
+      pthread_mutex_init(&(s->lock), NULL);
+  }
+
+  if (flags & GRAPH_CONCURRENT)
+    pthread_mutex_init(&(g->lock), NULL);
+
+  g->name = (char *) calloc(strlen(name) + 1, sizeof(char));
+  strcpy(g->name, name);
+  queue_init(&(g->vertex_list));
+  g->table = NULL;
+  g->size = g->capacity = 0;
+  g->flags = flags;
+  g->version_edges = 0;
+  g->versioned = (flags & GRAPH_SNAPSHOTS) != 0;
+  // without memory for it, graph_snapshot tries again
+  g->version = g->versioned ? version_create() : NULL;
+  g->log = NULL;
+
+  pool_init(&(g->vertex_pool), sizeof(vertex_t), pooled ? VERTEX_SLAB_ITEMS : 0);
+  pool_init(&(g->edge_pool), sizeof(edge_t), pooled ? EDGE_SLAB_ITEMS : 0);
+
+  TRACE_END(TRACE_CREATE_GRAPH);
+  return g;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+vertex_t *add_vertex (graph_t *g, int value, int id)
+{
+  if (!g)
+    return NULL;
+
+  graph_stripe_t *s = stripe_of(g, id);
+  vertex_t *new_vertex;
+
+  TRACE_BEGIN();
+  lock_stripe(g, s);
+  new_vertex = insert_vertex(g, s, value, id);
+  unlock_stripe(g, s);
+  TRACE_END(TRACE_ADD_VERTEX);
+
+  return new_vertex;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+vertex_t *find_or_add_vertex (graph_t *g, int value, int id)
+{
+  if (!g)
+    return NULL;
+
+  graph_stripe_t *s = stripe_of(g, id);
+  vertex_t *v;
+
+  TRACE_BEGIN();
+  lock_stripe(g, s);
+  if (!(v = (vertex_t *) hash_search(&(s->index), (uint32_t) id)))
+    v = insert_vertex(g, s, value, id);
+  unlock_stripe(g, s);
+  TRACE_END(TRACE_FIND_OR_ADD_VERTEX);
+
+  return v;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+vertex_t *remove_vertex (graph_t *g, vertex_t *v, int is_directed)
+{
+  if (!g || !v)
+    return NULL;
+
+  graph_stripe_t *s = stripe_of(g, v->id);
+  edge_t *e;
+
+  TRACE_BEGIN();
+  // the edges of v may belong to any stripe, the snapshots see the whole
+  // removal at once
+  lock_all(g);
+  lock_table(g);
+
+  // the last vertex takes the dense index of v
+  g->table[v->index] = g->table[--g->size];
+  g->table[v->index]->index = v->index;
+
+  if (g->flags & GRAPH_IN_EDGES) // every edge is reached in O(degree)
+  {
+    while (v->edges)
+      pool_free(&(g->edge_pool), unlink_edge(v, v->edges));
+
+    while (v->in_edges)
+      pool_free(&(g->edge_pool), unlink_edge(v->in_edges->vertex, v->in_edges->twin));
+  }
+  else if (is_directed)
+  {
+    while (v->edges)
+      pool_free(&(g->edge_pool), unlink_edge(v, v->edges));
+
+    // without in-edges lists the edges pointing to v must be searched
+    for (int i = 0; i < g->size; ++i)
+    {
+      graph_stripe_t *other = stripe_of(g, g->table[i]->id);
+
+      while (g->table[i]->degree && (e = find_edge(other, g->table[i], v)))
+        pool_free(&(g->edge_pool), unlink_edge(g->table[i], e));
+    }
+  }
+  else
+    while (v->edges) // removes all edges from the vertex
+    {
+      vertex_t *neighbour = v->edges->vertex;
+
+      pool_free(&(g->edge_pool), unlink_edge(v, v->edges));
+      // a self loop is removed only once
+      if (neighbour != v && (e = find_edge(stripe_of(g, neighbour->id), neighbour, v)))
+        pool_free(&(g->edge_pool), unlink_edge(neighbour, e));
+    }
+
+  if (hash_search(&(s->index), (uint32_t) v->id) == v) // keeps the index consistent
+    hash_remove(&(s->index), (uint32_t) v->id);
+
+  if (g->version && !version_remove(&(g->version), v->id))
+    lose_version(g);
+
+  if (g->log) // the replay removes the same edges
+    wal_append(g->log, WAL_REMOVE_VERTEX, v->id, is_directed, 0);
+
+  // v has no edges left
+  s->histogram[0]--;
+  s->size--;
+
+  queue_remove(&(g->vertex_list), (queue_t *) v);
+  unlock_table(g);
+  unlock_all(g);
+  TRACE_END(TRACE_REMOVE_VERTEX);
+
+  return v;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void release_vertex (graph_t *g, vertex_t *v)
+{
+  if (!g || !v)
+    return;
 
-  g->name = (char *) calloc(strlen(name), sizeof(char));
-  strcpy(g->name, name);
-  g->vertices = NULL;
-  g->size = 0;
+  TRACE_BEGIN();
+  pool_free(&(g->vertex_pool), v);
+  TRACE_END(TRACE_RELEASE_VERTEX);
+}
 
-  return g;
+/* ------------------------------------------------------------------------------ */
+
+int add_edge (vertex_t *v1, vertex_t *v2)
+{
+  return add_weighted_edge(v1, v2, 1.0);
 }
 
 /* ------------------------------------------------------------------------------ */
 
-vertex_t *add_vertex (graph_t *g, int value, int id)
+int add_weighted_edge (vertex_t *v1, vertex_t *v2, double weight)
 {
-  if (!g)
-    return NULL;
+  if (!v1 || !v2)
+    return 0;
 
-  vertex_t *new_vertex = (vertex_t *) malloc(sizeof(vertex_t));
+  graph_t *g = v1->graph;
+  graph_stripe_t *s1 = stripe_of(g, v1->id);
+  // the in-edges list of v2 belongs to its stripe
+  graph_stripe_t *s2 = (g->flags & GRAPH_IN_EDGES) ? stripe_of(g, v2->id) : s1;
+  int added;
 
-  g->size++;
+  TRACE_BEGIN();
+  lock_pair(g, s1, s2);
+  added = insert_edge(s1, v1, v2, weight);
 
-  new_vertex->next = new_vertex->prev = NULL;
-  new_vertex->edges = NULL;
-  new_vertex->degree = 0;
-  new_vertex->value = value;
-  new_vertex->id = id;
+  // logged while the stripes are held, so the log keeps the order of each
+  // edges list
+  if (added && g->log)
+    wal_append(g->log, weight == 1.0 ? WAL_ADD_EDGE : WAL_ADD_WEIGHTED_EDGE, v1->id, v2->id, weight);
 
-  queue_append((queue_t **) &(g->vertices), (queue_t *) new_vertex);
-  return new_vertex;
+  unlock_pair(g, s1, s2);
+  TRACE_END(TRACE_ADD_EDGE);
+
+  return added;
 }
 
 /* ------------------------------------------------------------------------------ */
 
-vertex_t *remove_vertex (graph_t *g, vertex_t *v, int is_directed)
+// batch keys: source and destination dense indices, sorted by source
+static inline uint64_t batch_key (vertex_t *v1, vertex_t *v2)
 {
-  if (!g || !v)
+  return ((uint64_t) (uint32_t) v1->index << 32) | (uint32_t) v2->index;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int compare_keys (const void *a, const void *b)
+{
+  uint64_t k1 = *(const uint64_t *) a, k2 = *(const uint64_t *) b;
+
+  return (k1 > k2) - (k1 < k2);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// lsd radix sort with 16 bit digits, the digits shared by every key are
+// skipped. The result may end up in tmp, the returned pointer tells where.
+// Below RADIX_MIN keys the 512 KB of counters cost more than a qsort.
+static uint64_t *radix_sort (uint64_t *keys, uint64_t *tmp, size_t n)
+{
+  if (n < RADIX_MIN)
+  {
+    qsort(keys, n, sizeof(uint64_t), compare_keys);
+    return keys;
+  }
+
+  size_t *count = (size_t *) malloc(65536 * sizeof(size_t));
+
+  if (!count)
     return NULL;
 
-  g->size--;
+  for (int shift = 0; shift < 64; shift += 16)
+  {
+    size_t pos = 0;
+
+    memset(count, 0, 65536 * sizeof(size_t));
+    for (size_t i = 0; i < n; ++i)
+      count[(keys[i] >> shift) & 0xffff]++;
+
+    if (count[(keys[0] >> shift) & 0xffff] == n) // nothing to do
+      continue;
+
+    for (size_t d = 0; d < 65536; ++d) // bucket starts
+    {
+      size_t c = count[d];
+
+      count[d] = pos;
+      pos += c;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+      tmp[count[(keys[i] >> shift) & 0xffff]++] = keys[i];
+
+    uint64_t *aux = keys;
+
+    keys = tmp;
+    tmp = aux;
+  }
+
+  free(count);
+  return keys;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// attaches the sorted batch, one run of edges per source. Repeated keys and
+// edges that are already in the graph are skipped.
+static long attach_batch (graph_t *g, uint64_t *sorted, size_t total)
+{
+  edge_t *block = NULL, *twins = NULL;
+  size_t used = 0, kept = 0;
+  long added = 0;
+  int error = 0;
+
+  // keeps only the new edges, so everything below is sized exactly (a vertex
+  // without edges cannot have any of them yet)
+  for (size_t i = 0; i < total; ++i)
+  {
+    vertex_t *v1 = g->table[sorted[i] >> 32];
+
+    if ((kept && sorted[i] == sorted[kept - 1]) ||
+        (v1->degree && find_edge(stripe_of(g, v1->id), v1, g->table[(uint32_t) sorted[i]])))
+      continue;
+
+    sorted[kept++] = sorted[i];
+  }
+
+  if (!(total = kept))
+    return 0;
+
+  // one block for all the new edges, followed by their in-edges
+  if (!(g->flags & GRAPH_NO_POOL))
+  {
+    size_t items = (g->flags & GRAPH_IN_EDGES) ? 2 * total : total;
+
+    if (!(block = (edge_t *) pool_alloc_block(&(g->edge_pool), items)))
+      return -1;
+    if (g->flags & GRAPH_IN_EDGES)
+      twins = block + total;
+  }
+
+  // grows each edge set once, the batch edges are counted by stripe first
+  if (!(g->flags & GRAPH_NO_EDGE_SET))
+  {
+    size_t *count = (size_t *) calloc(g->stripe_count, sizeof(size_t));
+
+    if (!count)
+      return -1;
+
+    for (size_t start = 0, end = 0; start < total; start = end)
+    {
+      while (end < total && (sorted[end] >> 32) == (sorted[start] >> 32))
+        end++;
 
-  while(v->edges) // removes all edges from the vertex
+      count[stripe_of(g, g->table[sorted[start] >> 32]->id) - g->stripes] += end - start;
+    }
+
+    for (int i = 0; i < g->stripe_count && !error; ++i)
+      if (count[i] && !hash_reserve(&(g->stripes[i].edge_set), g->stripes[i].edge_set.count + count[i]))
+        error = 1;
+
+    free(count);
+    if (error)
+      return -1;
+  }
+
+  for (size_t start = 0, end = 0; start < total && !error; start = end)
   {
-    if (is_directed)
+    vertex_t *v1 = g->table[sorted[start] >> 32];
+    graph_stripe_t *s = stripe_of(g, v1->id);
+    queue_head_t run_edges;
+    int run;
+
+    while (end < total && (sorted[end] >> 32) == (uint64_t) v1->index)
+      end++;
+
+    if (!reserve_degree(s, v1->degree + (int) (end - start)))
     {
-      free(remove_edge(v->edges->vertex, v));
-      free(queue_remove((queue_t **) &(v->edges), (queue_t *) v->edges));
+      error = 1;
+      break;
     }
-    else
+
+    queue_init(&run_edges);
+
+    for (size_t i = start; i < end; ++i)
     {
-      free(remove_edge(v->edges->vertex, v));
-      free(remove_edge(v, v->edges->vertex));
+      vertex_t *v2 = g->table[(uint32_t) sorted[i]];
+      edge_t *e = block ? &block[used] : (edge_t *) pool_alloc(&(g->edge_pool));
+      edge_t *twin = NULL;
+
+      if (e && (g->flags & GRAPH_IN_EDGES))
+        twin = twins ? &twins[used] : (edge_t *) pool_alloc(&(g->edge_pool));
+
+      if (!e || ((g->flags & GRAPH_IN_EDGES) && !twin) ||
+          (!(g->flags & GRAPH_NO_EDGE_SET) && !hash_insert(&(s->edge_set), edge_key(v1, v2), e)))
+      {
+        if (!block) // the block items are simply left unused
+        {
+          pool_free(&(g->edge_pool), e);
+          pool_free(&(g->edge_pool), twin);
+        }
+
+        error = 1;
+        break;
+      }
+
+      used++;
+      e->vertex = v2;
+      e->twin = twin;
+      e->weight = 1.0;
+
+      if (twin)
+      {
+        twin->vertex = v1;
+        twin->twin = e;
+        twin->weight = 1.0;
+        queue_append(&(v2->in_edge_list), (queue_t *) twin);
+      }
+
+      // builds the run apart, it is attached to v1 at once below
+      queue_append(&run_edges, (queue_t *) e);
+      track_edge(g, v1, v2, 1);
+
+      if (v1 == v2)
+        s->self_loops++;
     }
+
+    if (!(run = (int) queue_size(&run_edges)))
+      continue;
+
+    queue_splice(&(v1->edge_list), &run_edges);
+    set_degree(s, v1, v1->degree + run);
+    added += run;
   }
 
-  return (vertex_t *) queue_remove((queue_t **) &(g->vertices), (queue_t *) v);
+  TRACE_COUNT(TRACE_EDGES, (g->flags & GRAPH_IN_EDGES) ? 2 * used : used);
+  return error ? -1 : added;
 }
 
 /* ------------------------------------------------------------------------------ */
 
-int add_edge (vertex_t *v1, vertex_t *v2)
+long graph_add_edges (graph_t *g, const int *src, const int *dst, size_t n, int flags)
 {
-  if (!v1 || !v2)
-    return 0;
+  if (!g || (n && (!src || !dst)))
+    return -1;
 
-  edge_t *new_edge = (edge_t *) malloc(sizeof(edge_t));
+  int undirected = flags & BATCH_UNDIRECTED;
+  size_t total = undirected ? 2 * n : n;
+  uint64_t *keys = (uint64_t *) malloc((total + 1) * sizeof(uint64_t));
+  uint64_t *tmp = (uint64_t *) malloc((total + 1) * sizeof(uint64_t));
+  uint64_t *sorted = keys;
+  long added = -1;
 
-  new_edge->vertex = v2;
-  new_edge->next = new_edge->prev = NULL;
-  // inserts v2 in v1
-  queue_append((queue_t **) &(v1->edges), (queue_t *) new_edge);
-  v1->degree++;
+  TRACE_BEGIN();
+  // the batch runs alone, it uses the dense indices
+  lock_all(g);
 
-  return 1;
+  if (keys && tmp)
+  {
+    // creates the missing vertices in order of appearance
+    for (size_t i = 0; i < n && sorted; ++i)
+    {
+      vertex_t *v1, *v2;
+
+      if (!(v1 = fetch_vertex(g, src[i])) || !(v2 = fetch_vertex(g, dst[i])))
+      {
+        sorted = NULL;
+        break;
+      }
+
+      keys[i] = batch_key(v1, v2);
+      if (undirected)
+        keys[n + i] = batch_key(v2, v1);
+    }
+
+    if (sorted && total)
+      sorted = radix_sort(keys, tmp, total);
+
+    if (sorted && total) // the snapshots see the whole batch at once
+    {
+      lock_table(g);
+      added = attach_batch(g, sorted, total);
+      unlock_table(g);
+    }
+    else if (sorted)
+      added = 0;
+  }
+
+  if (g->log && added >= 0)
+    wal_append_batch(g->log, src, dst, n, flags);
+  else if (g->log) // part of the batch may be in the graph, not in the log
+    wal_fail(g->log);
+
+  unlock_all(g);
+  free(keys);
+  free(tmp);
+  TRACE_END(TRACE_ADD_EDGES);
+  return added;
 }
 
 /* ------------------------------------------------------------------------------ */
@@ -86,16 +902,40 @@ edge_t *remove_edge (vertex_t *v1, vertex_t *v2)
   if (!v1 || !v2)
     return NULL;
 
+  graph_t *g = v1->graph;
+  graph_stripe_t *s1 = stripe_of(g, v1->id);
+  graph_stripe_t *s2 = (g->flags & GRAPH_IN_EDGES) ? stripe_of(g, v2->id) : s1;
   edge_t *aux_edge;
 
-  if ((aux_edge = search_edge(v1->edges, v2)))
+  TRACE_BEGIN();
+  lock_pair(g, s1, s2);
+  if ((aux_edge = find_edge(s1, v1, v2)))
   {
-    v1->degree--;
-    // removes v2 from v1
-    return (edge_t *) queue_remove((queue_t **) &(v1->edges), (queue_t *) aux_edge);
+    if (g->versioned)
+      lock_table(g);
+    unlink_edge(v1, aux_edge);
+    if (g->versioned)
+      unlock_table(g);
+
+    if (g->log)
+      wal_append(g->log, WAL_REMOVE_EDGE, v1->id, v2->id, 0);
   }
+  unlock_pair(g, s1, s2);
+  TRACE_END(TRACE_REMOVE_EDGE);
 
-  return NULL;
+  return aux_edge;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void release_edge (graph_t *g, edge_t *e)
+{
+  if (!g || !e)
+    return;
+
+  TRACE_BEGIN();
+  pool_free(&(g->edge_pool), e);
+  TRACE_END(TRACE_RELEASE_EDGE);
 }
 
 /* ------------------------------------------------------------------------------ */
@@ -105,14 +945,13 @@ edge_t *search_edge (edge_t *e, vertex_t *v)
   if (!e || !v)
     return NULL;
 
-  edge_t *edge_it = e;
+  edge_t *found;
 
-  do
-    if (edge_it->vertex == v) // if the edge is found
-      return edge_it;
-  while ((edge_it = edge_it->next) != e);
+  TRACE_BEGIN();
+  found = scan_edges(e, v);
+  TRACE_END(TRACE_SEARCH_EDGE);
 
-  return NULL;
+  return found;
 }
 
 /* ------------------------------------------------------------------------------ */
@@ -125,6 +964,7 @@ void print_graph (graph_t *g, int is_directed)
   vertex_t *vertex_it = g->vertices;
   edge_t *edge_it;
 
+  TRACE_BEGIN();
   printf("graph: %s | nodes: %d | edges: %d\n", g->name, g->size, edge_count(g, is_directed));
 
   for (int i = 0; i < g->size; ++i)
@@ -139,40 +979,138 @@ void print_graph (graph_t *g, int is_directed)
     vertex_it = vertex_it->next;
     printf("\n");
   }
+
+  TRACE_END(TRACE_PRINT_GRAPH);
 }
 
 /* ------------------------------------------------------------------------------ */
 
 int edge_count (graph_t *g, int is_directed)
 {
-  vertex_t *vertex_it = g->vertices;
-  int sum = 0;
+  if (!g)
+    return 0;
 
-  do
-    sum += vertex_it->degree; // sum all the vertices degrees
-  while ((vertex_it = vertex_it->next) != g->vertices);
+  long edges = 0, self_loops = 0;
 
-  return is_directed ? sum : (sum/2);
+  TRACE_BEGIN();
+  for (int i = 0; i < g->stripe_count; ++i)
+  {
+    lock_stripe(g, &(g->stripes[i]));
+    edges += g->stripes[i].edges;
+    self_loops += g->stripes[i].self_loops;
+    unlock_stripe(g, &(g->stripes[i]));
+  }
+
+  TRACE_END(TRACE_EDGE_COUNT);
+
+  // undirected edges are stored twice, except self loops
+  return is_directed ? edges : (edges + self_loops) / 2;
 }
 
 /* ------------------------------------------------------------------------------ */
 
-vertex_t *get_vertex_by_id (graph_t *g, int id)
+int max_degree (graph_t *g)
 {
   if (!g)
-    return NULL;
+    return -1;
 
-  vertex_t *vertex_it = g->vertices;
+  int max = -1;
+
+  TRACE_BEGIN();
+  for (int i = 0; i < g->stripe_count; ++i)
+  {
+    graph_stripe_t *s = &(g->stripes[i]);
+
+    lock_stripe(g, s);
+    if (s->size && s->max_degree > max)
+      max = s->max_degree;
+    unlock_stripe(g, s);
+  }
+
+  TRACE_END(TRACE_MAX_DEGREE);
+  return max;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int min_degree (graph_t *g)
+{
+  if (!g)
+    return -1;
+
+  int min = -1;
+
+  TRACE_BEGIN();
+  for (int i = 0; i < g->stripe_count; ++i)
+  {
+    graph_stripe_t *s = &(g->stripes[i]);
+
+    lock_stripe(g, s);
+    if (s->size)
+    {
+      while (!s->histogram[s->min_degree])
+        s->min_degree++;
+
+      if (min < 0 || s->min_degree < min)
+        min = s->min_degree;
+    }
+    unlock_stripe(g, s);
+  }
+
+  TRACE_END(TRACE_MIN_DEGREE);
+  return min;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int degree_histogram (graph_t *g, int *histogram, int size)
+{
+  if (!g)
+    return 0;
+
+  int used = 0;
+
+  TRACE_BEGIN();
+  for (int i = 0; i < size && histogram; ++i)
+    histogram[i] = 0;
+
+  for (int i = 0; i < g->stripe_count; ++i)
+  {
+    graph_stripe_t *s = &(g->stripes[i]);
+
+    lock_stripe(g, s);
+    if (s->size)
+    {
+      if (s->max_degree + 1 > used)
+        used = s->max_degree + 1;
 
-  if (!g->vertices)
+      for (int d = 0; d <= s->max_degree && d < size && histogram; ++d)
+        histogram[d] += s->histogram[d];
+    }
+    unlock_stripe(g, s);
+  }
+
+  TRACE_END(TRACE_DEGREE_HISTOGRAM);
+  return used;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+vertex_t *get_vertex_by_id (graph_t *g, int id)
+{
+  if (!g)
     return NULL;
 
-  do
-    if (vertex_it->id == id) // if the vertex has that id
-      return vertex_it;
-  while ((vertex_it = vertex_it->next) != g->vertices);
+  graph_stripe_t *s = stripe_of(g, id);
+  vertex_t *v;
 
-  return NULL;
+  TRACE_BEGIN();
+  lock_stripe(g, s);
+  v = (vertex_t *) hash_search(&(s->index), (uint32_t) id);
+  unlock_stripe(g, s);
+  TRACE_END(TRACE_GET_VERTEX_BY_ID);
+
+  return v;
 }
 
 /* ------------------------------------------------------------------------------ */
@@ -182,15 +1120,35 @@ int search_neighbourhood (vertex_t *v1, vertex_t *v2)
   if (!v1 || !v2)
     return 0;
 
-  edge_t *edge_it;
+  graph_stripe_t *s = stripe_of(v1->graph, v1->id);
+  int found;
 
-  if ((edge_it = v1->edges))
-    do
-      if (edge_it->vertex == v2) // checks if v1 has v2 as a neighbour
-        return 1;
-    while ((edge_it = edge_it->next) != v1->edges);
+  TRACE_BEGIN();
+  lock_stripe(v1->graph, s);
+  found = find_edge(s, v1, v2) != NULL;
+  unlock_stripe(v1->graph, s);
+  TRACE_END(TRACE_SEARCH_NEIGHBOURHOOD);
+
+  return found;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+edge_t *get_edge (vertex_t *v1, vertex_t *v2)
+{
+  if (!v1 || !v2)
+    return NULL;
+
+  graph_stripe_t *s = stripe_of(v1->graph, v1->id);
+  edge_t *e;
+
+  TRACE_BEGIN();
+  lock_stripe(v1->graph, s);
+  e = find_edge(s, v1, v2);
+  unlock_stripe(v1->graph, s);
+  TRACE_END(TRACE_GET_EDGE);
 
-  return 0;
+  return e;
 }
 
 /* ------------------------------------------------------------------------------ */
@@ -200,11 +1158,14 @@ int search_vertex_in_array (vertex_t *v, vertex_t **array, int array_size)
   if (!v || !array)
     return 0;
 
-  for (int i = 0; i < array_size; ++i)
-    if (array[i] == v) // if the vertex is found
-      return 1;
+  int found = 0;
 
-  return 0;
+  TRACE_BEGIN();
+  for (int i = 0; i < array_size && !found; ++i)
+    found = array[i] == v; // if the vertex is found
+  TRACE_END(TRACE_SEARCH_VERTEX_IN_ARRAY);
+
+  return found;
 }
 
 /* ------------------------------------------------------------------------------ */
@@ -212,48 +1173,56 @@ int search_vertex_in_array (vertex_t *v, vertex_t **array, int array_size)
 graph_t *read_graph (char *name, FILE *input, int is_directed)
 {
   int rd, nodes[2];
-  char *str = (char *) malloc(256);
+  double weight = 1.0;
+  reader_t r;
+
+  if (!input || !reader_init(&r, input))
+    return NULL;
 
+  TRACE_BEGIN();
   graph_t *g = create_graph(name);
   vertex_t *v1, *v2;
 
-  while (fgets(str, 256, input))
-  {
-    if (str[0] != '\n')
+  while ((rd = reader_edge(&r, nodes, &weight)) > 0)
+    switch (rd)
     {
-      rd = sscanf(str, "%d %d", &nodes[0], &nodes[1]);
+      case 1:
+        if (!get_vertex_by_id(g, nodes[0]))
+          add_vertex(g, nodes[0], nodes[0]);
 
-      switch (rd)
-      {
-        case 1:
-          if (!get_vertex_by_id(g, nodes[0]))
-            add_vertex(g, nodes[0], nodes[0]);
-
-          break;
+        break;
 
-        case 2:
-          if (!(v1 = get_vertex_by_id(g, nodes[0])))
-            v1 = add_vertex(g, nodes[0], nodes[0]);
+      case 3:
+        g->flags |= GRAPH_WEIGHTED;
+        // fall through
 
-          if (!(v2 = get_vertex_by_id(g, nodes[1])))
-            v2 = add_vertex(g, nodes[1], nodes[1]);
+      case 2:
+        if (!(v1 = get_vertex_by_id(g, nodes[0])))
+          v1 = add_vertex(g, nodes[0], nodes[0]);
 
-          if (!search_neighbourhood(v1, v2))
-            add_edge(v1, v2);
+        if (!(v2 = get_vertex_by_id(g, nodes[1])))
+          v2 = add_vertex(g, nodes[1], nodes[1]);
 
-          if (!is_directed && !search_neighbourhood(v2, v1))
-            add_edge(v2, v1);
+        if (!search_neighbourhood(v1, v2))
+          add_weighted_edge(v1, v2, weight);
 
-          break;
+        if (!is_directed && !search_neighbourhood(v2, v1))
+          add_weighted_edge(v2, v1, weight);
 
-        default:
-          fprintf(stderr, "Error: Unable to read input\n");
-          exit(1);
-      }
+        weight = 1.0;
+        break;
     }
+
+  if (rd < 0) // badly formatted input
+  {
+    fprintf(stderr, "Error: Unable to read input (line %zu)\n", r.line);
+    destroy_graph(g);
+    g = NULL;
   }
 
-  free(str);
+  TRACE_COUNT(TRACE_LINES, r.line);
+  reader_close(&r);
+  TRACE_END(TRACE_READ_GRAPH);
   return g;
 }
 
@@ -266,46 +1235,186 @@ graph_t *write_graph (graph_t *g, FILE *output, int is_directed)
 
   edge_t *edge_it;
   vertex_t *vertex_it;
-  vertex_t **visited = (vertex_t **) malloc(g->size * sizeof(vertex_t *));
+  writer_t w;
+  TRACE_BEGIN();
+  // one bit per dense index
+  unsigned char *visited = (unsigned char *) calloc(g->size / 8 + 1, sizeof(unsigned char));
 
-  int i = 0, array_size = 0;
+  if (!visited || !writer_init(&w, output))
+  {
+    free(visited);
+    return NULL;
+  }
 
   if ((vertex_it = g->vertices))
     do
     {
       if ((edge_it = vertex_it->edges)) // if it has edges
         do
+        {
+          int index = edge_it->vertex->index;
+
           // if the vertex was not written
-          if (is_directed || !search_vertex_in_array(edge_it->vertex, visited, array_size))
-            fprintf(output, "%d %d\n", vertex_it->id, edge_it->vertex->id);
+          if (is_directed || !(visited[index >> 3] & (1 << (index & 7))))
+          {
+            writer_int(&w, vertex_it->id, ' ');
+
+            if (g->flags & GRAPH_WEIGHTED)
+            {
+              writer_int(&w, edge_it->vertex->id, ' ');
+              writer_double(&w, edge_it->weight, '\n');
+            }
+            else
+              writer_int(&w, edge_it->vertex->id, '\n');
+          }
+        }
         while ((edge_it = edge_it->next) != vertex_it->edges);
       else
-        fprintf(output, "%d\n", vertex_it->id);
+        writer_int(&w, vertex_it->id, '\n');
 
-      visited[i++] = vertex_it;
-      array_size++;
+      visited[vertex_it->index >> 3] |= 1 << (vertex_it->index & 7);
     }
     while ((vertex_it = vertex_it->next) != g->vertices);
 
   free(visited);
+  if (!writer_close(&w))
+    return NULL;
+
+  TRACE_END(TRACE_WRITE_GRAPH);
   return g;
 }
 
 /* ------------------------------------------------------------------------------ */
 
+// builds the current version from the whole graph (every stripe and the
+// table must be held)
+static int build_version (graph_t *g)
+{
+  edge_t *edge_it;
+
+  if (!(g->version = version_create()))
+    return 0;
+
+  for (int i = 0; i < g->size; ++i)
+  {
+    vertex_t *v = g->table[i];
+    snapshot_vertex_t *leaf;
+
+    if (!version_insert(&(g->version), v->id, v->value) || !(leaf = version_vertex(&(g->version), v->id)))
+    {
+      lose_version(g);
+      return 0;
+    }
+
+    if ((edge_it = v->edges))
+      do
+        if (!version_link(leaf, edge_it->vertex->id))
+        {
+          lose_version(g);
+          return 0;
+        }
+      while ((edge_it = edge_it->next) != v->edges);
+
+    g->version_edges += v->degree;
+  }
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+snapshot_t *graph_snapshot (graph_t *g)
+{
+  if (!g)
+    return NULL;
+
+  snapshot_t *s = (snapshot_t *) malloc(sizeof(snapshot_t));
+  int building = 0;
+
+  if (!s)
+    return NULL;
+
+  TRACE_BEGIN();
+  s->root = NULL;
+  lock_table(g);
+
+  if (!g->version) // first snapshot (or the version was lost)
+  {
+    // nothing can change while the version is built
+    unlock_table(g);
+    lock_all(g);
+    lock_table(g);
+    building = 1;
+
+    if (!g->version)
+      build_version(g);
+    g->versioned = 1;
+  }
+
+  if (g->version) // shares the whole version
+  {
+    version_retain(g->version);
+    s->root = g->version;
+    s->size = g->size;
+    s->edges = g->version_edges;
+  }
+
+  unlock_table(g);
+  if (building)
+    unlock_all(g);
+
+  TRACE_END(TRACE_GRAPH_SNAPSHOT);
+
+  if (!s->root)
+  {
+    free(s);
+    return NULL;
+  }
+
+  return s;
+}
+
+/* ------------------------------------------------------------------------------ */
+
 int destroy_graph (graph_t *g)
 {
   if (!g)
     return 0;
 
-  while (g->vertices) // while there is vertices to be removed
+  TRACE_BEGIN();
+  if (g->flags & GRAPH_NO_POOL)
+    while (g->vertices) // while there is vertices to be removed
+    {
+      while (g->vertices->edges) // while there is edges to be removed
+        free(queue_remove(&(g->vertices->edge_list), (queue_t *) g->vertices->edges));
+      while (g->vertices->in_edges)
+        free(queue_remove(&(g->vertices->in_edge_list), (queue_t *) g->vertices->in_edges));
+      free(queue_remove(&(g->vertex_list), (queue_t *) g->vertices));
+    }
+
+  // frees every pooled vertex and edge at once
+  pool_destroy(&(g->vertex_pool));
+  pool_destroy(&(g->edge_pool));
+
+  for (int i = 0; i < g->stripe_count; ++i)
   {
-    while (g->vertices->edges) // while there is edges to be removed
-      free(queue_remove((queue_t **) &(g->vertices->edges), (queue_t *) g->vertices->edges));
-    free(queue_remove((queue_t **) &(g->vertices), (queue_t *) g->vertices));
+    hash_destroy(&(g->stripes[i].index));
+    hash_destroy(&(g->stripes[i].edge_set));
+    free(g->stripes[i].histogram);
+
+    if (g->flags & GRAPH_CONCURRENT)
+      pthread_mutex_destroy(&(g->stripes[i].lock));
   }
 
+  if (g->flags & GRAPH_CONCURRENT)
+    pthread_mutex_destroy(&(g->lock));
+
+  // the snapshots keep their own references
+  version_release(g->version);
+  free(g->stripes);
+  free(g->table);
   free(g->name);
   free(g);
+  TRACE_END(TRACE_DESTROY_GRAPH);
   return 1;
 }
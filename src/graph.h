@@ -3,32 +3,153 @@
 
 /* ------------------------------------------------------------------------------ */
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
+#include "hash.h"
+#include "pool.h"
 #include "queue.h"
+#include "reader.h"
+#include "snapshot.h"
+#include "trace.h"
+#include "writer.h"
+
+/* ------------------------------------------------------------------------------
+ * graph flags (see create_graph_flags)
+ * ------------------------------------------------------------------------------
+ * GRAPH_NO_POOL: vertices and edges are allocated with malloc instead of the
+ * graph pools
+ * GRAPH_NO_EDGE_SET: the graph does not keep the edge set, so the edge
+ * queries scan the edges lists (saves memory)
+ * GRAPH_IN_EDGES: every vertex also keeps the list of edges that point to it,
+ * so removing a vertex from a directed graph takes O(degree) instead of a
+ * search over the whole graph
+ * GRAPH_WEIGHTED: write_graph writes the weight of every edge (read_graph sets
+ * it when the input has weights)
+ * GRAPH_CONCURRENT: the graph can be changed by many threads at once. The
+ * vertex index, the edge set and the edges lists are split in GRAPH_STRIPES
+ * stripes (by vertex id), each one with its own lock, so add_vertex,
+ * find_or_add_vertex, get_vertex_by_id, add_edge, remove_edge,
+ * search_neighbourhood and the counters only wait for threads that use the
+ * same stripes. remove_vertex and graph_add_edges take every lock. The
+ * traversals, write_graph, print_graph, freeze_graph and relabel_graph are not
+ * thread safe.
+ * Removed vertices and edges must only be released when no other thread can
+ * still hold them. Implies GRAPH_NO_POOL.
+ * GRAPH_SNAPSHOTS: the graph keeps its current version from the start, so
+ * graph_snapshot takes O(1) (without it the first call builds the version).
+ * Every change then also takes the graph lock to update the version, which
+ * serializes that part of the GRAPH_CONCURRENT writers.
+ * ------------------------------------------------------------------------------ */
+
+#define GRAPH_NO_POOL 0x01
+#define GRAPH_NO_EDGE_SET 0x02
+#define GRAPH_IN_EDGES 0x04
+#define GRAPH_WEIGHTED 0x08
+#define GRAPH_CONCURRENT 0x10
+#define GRAPH_SNAPSHOTS 0x20
+
+/* ------------------------------------------------------------------------------ */
+
+#define GRAPH_STRIPES 64
+
+/* ------------------------------------------------------------------------------
+ * batch flags (see graph_add_edges)
+ * ------------------------------------------------------------------------------
+ * BATCH_UNDIRECTED: every pair is also added in the opposite direction
+ * ------------------------------------------------------------------------------ */
+
+#define BATCH_UNDIRECTED 0x01
 
 /* ------------------------------------------------------------------------------ */
 
 typedef struct graph_t graph_t ;
+typedef struct graph_stripe_t graph_stripe_t ;
 typedef struct vertex_t vertex_t ;
 typedef struct edge_t edge_t ;
+typedef struct wal_t wal_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: graph stripe
+ * ------------------------------------------------------------------------------
+ * part of the graph that belongs to a set of vertex ids. A graph has a single
+ * stripe, or GRAPH_STRIPES of them with GRAPH_CONCURRENT. The stripe of a
+ * vertex also owns its edges lists and the edges that leave it.
+ *
+ * lock: lock of the stripe (only with GRAPH_CONCURRENT)
+ * index: vertex index (id -> vertex)
+ * edge_set: edge index ((source id, destination id) -> edge)
+ * size: number of vertices
+ * parallel_edges: number of repeated edges that are not in the edge set
+ * edges: number of edges (sum of the degrees)
+ * self_loops: number of edges from a vertex to itself
+ * histogram: number of vertices with each degree (histogram_size entries)
+ * histogram_size: number of slots in histogram
+ * min_degree: lower bound of the smallest degree (fixed when it is queried)
+ * max_degree: largest degree
+ * ------------------------------------------------------------------------------ */
+
+struct graph_stripe_t
+{
+  pthread_mutex_t lock ;
+  hash_t index ;
+  hash_t edge_set ;
+  int size ;
+  int parallel_edges ;
+  long edges ;
+  int self_loops ;
+  int *histogram ;
+  int histogram_size ;
+  int min_degree ;
+  int max_degree ;
+} __attribute__((aligned(64))) ; // one stripe never shares a cache line
 
 /* ------------------------------------------------------------------------------
  * structure: graph
  * ------------------------------------------------------------------------------
- * vertices: graph vertices
+ * vertices: graph vertices (first element of vertex_list)
+ * vertex_list: counted queue of the vertices, used by the queue functions
+ * table: vertices by dense index (table[v->index] == v)
+ * stripes: vertex index, edge set and degree counters, split by vertex id
+ * stripe_count: number of stripes (a power of two)
+ * lock: protects vertices, table and version (only with GRAPH_CONCURRENT)
+ * version: current version of the graph, shared with its snapshots (NULL if
+ * it is not kept, see graph_snapshot)
+ * version_edges: number of edges in version
+ * versioned: indicates if the graph keeps a version (1) or not (0), only
+ * changed while every stripe is held
+ * log: write-ahead log that receives the changes (NULL if none, see wal.h)
+ * vertex_pool: allocator of the graph vertices
+ * edge_pool: allocator of the graph edges
  * name: graph name
  * size: graph size (number of vertices)
+ * capacity: number of slots in table
+ * flags: graph flags
  * ------------------------------------------------------------------------------ */
 
 struct graph_t
 {
-  vertex_t *vertices ;
+  union
+  {
+    vertex_t *vertices ;
+    queue_head_t vertex_list ;
+  } ;
+  vertex_t **table ;
+  graph_stripe_t *stripes ;
+  int stripe_count ;
+  pthread_mutex_t lock ;
+  snapshot_node_t *version ;
+  long version_edges ;
+  int versioned ;
+  wal_t *log ;
+  pool_t vertex_pool, edge_pool ;
   char *name ;
   int size ;
+  int capacity ;
+  int flags ;
 } ;
 
 /* ------------------------------------------------------------------------------
@@ -36,18 +157,37 @@ struct graph_t
  * ------------------------------------------------------------------------------
  * prev: pointer to the previous vertex
  * next: pointer to the next vertex
- * edges: pointer to a list of edges that connect to the vertex
+ * edges: pointer to a list of edges that connect to the vertex (first
+ * element of edge_list)
+ * edge_list: counted queue of the edges, used by the queue functions
+ * in_edges: pointer to a list of edges from the vertices that point to this
+ * one (only with GRAPH_IN_EDGES, the edge vertex is the source)
+ * in_edge_list: counted queue of the in-edges, its size is the in-degree
+ * graph: graph that owns the vertex
  * value: vertex value (generic)
  * degree: current vertex degree
+ * index: dense index of the vertex, from 0 to size - 1. When a vertex is
+ * removed the last vertex takes its index.
  * id: vertex id (must be unique)
  * ------------------------------------------------------------------------------ */
 
 struct vertex_t
 {
   vertex_t *prev, *next ;
-  edge_t *edges ;
+  union
+  {
+    edge_t *edges ;
+    queue_head_t edge_list ;
+  } ;
+  union
+  {
+    edge_t *in_edges ;
+    queue_head_t in_edge_list ;
+  } ;
+  graph_t *graph ;
   int value ;
   int degree ;
+  int index ;
   int id ;
 } ;
 
@@ -57,12 +197,17 @@ struct vertex_t
  * prev: pointer to the previous edge
  * next: pointer to the next edge
  * vertex: vertex connected to this edge
+ * twin: matching edge in the in-edges list of the other end, or the matching
+ * out-edge for an in-edge (NULL without GRAPH_IN_EDGES)
+ * weight: edge weight (1 unless given by add_weighted_edge or read_graph)
  * ------------------------------------------------------------------------------ */
 
 struct edge_t
 {
   edge_t *prev, *next ;
   vertex_t *vertex ;
+  edge_t *twin ;
+  double weight ;
 } ;
 
 /* ------------------------------------------------------------------------------
@@ -77,6 +222,19 @@ struct edge_t
 
 graph_t *create_graph (char *name) ;
 
+/* ------------------------------------------------------------------------------
+ * function: create_graph_flags
+ * ------------------------------------------------------------------------------
+ * creates a graph with a given name and flags
+ *
+ * name: name of the graph to be created
+ * flags: bitwise or of the GRAPH_* flags (0 gives the same as create_graph)
+ *
+ * returns: pointer to the created graph
+ * ------------------------------------------------------------------------------ */
+
+graph_t *create_graph_flags (char *name, int flags) ;
+
 /* ------------------------------------------------------------------------------
  * function: add_vertex
  * ------------------------------------------------------------------------------
@@ -91,6 +249,21 @@ graph_t *create_graph (char *name) ;
 
 vertex_t *add_vertex (graph_t *g, int value, int id) ;
 
+/* ------------------------------------------------------------------------------
+ * function: find_or_add_vertex
+ * ------------------------------------------------------------------------------
+ * searches for a vertex with a given id and inserts it if it is not found.
+ * With GRAPH_CONCURRENT two threads never insert the same id.
+ *
+ * g: graph in which the vertex will be searched or inserted
+ * value: vertex value (only used if the vertex is inserted)
+ * id: vertex id
+ *
+ * returns: pointer to the found or added vertex
+ * ------------------------------------------------------------------------------ */
+
+vertex_t *find_or_add_vertex (graph_t *g, int value, int id) ;
+
 /* ------------------------------------------------------------------------------
  * function: remove_vertex
  * ------------------------------------------------------------------------------
@@ -100,11 +273,27 @@ vertex_t *add_vertex (graph_t *g, int value, int id) ;
  * v: vertex to be removed
  * is_directed: indicates if the graph is directed (1) or not (0)
  *
+ * In directed graphs the edges that point to v are also removed, which takes
+ * O(degree) with GRAPH_IN_EDGES and a pass over every vertex without it.
+ * The removed vertex still belongs to the graph memory, it must be given
+ * back with release_vertex (never with free).
+ *
  * returns: pointer to the removed vertex
  * ------------------------------------------------------------------------------ */
 
 vertex_t *remove_vertex (graph_t *g, vertex_t *v, int is_directed) ;
 
+/* ------------------------------------------------------------------------------
+ * function: release_vertex
+ * ------------------------------------------------------------------------------
+ * gives a removed vertex back to the graph, so its memory can be reused
+ *
+ * g: graph from which the vertex was removed
+ * v: vertex returned by remove_vertex
+ * ------------------------------------------------------------------------------ */
+
+void release_vertex (graph_t *g, vertex_t *v) ;
+
 /* ------------------------------------------------------------------------------
  * function: add_edge
  * ------------------------------------------------------------------------------
@@ -120,21 +309,73 @@ vertex_t *remove_vertex (graph_t *g, vertex_t *v, int is_directed) ;
 
 int add_edge (vertex_t *v1, vertex_t *v2) ;
 
+/* ------------------------------------------------------------------------------
+ * function: add_weighted_edge
+ * ------------------------------------------------------------------------------
+ * inserts an edge from v1 to v2 with a given weight (add_edge uses weight 1).
+ * If the graph is undirected, this function must be called for both ends.
+ *
+ * v1: vertex that will receive v2 in its neighbourhood
+ * v2: vertex that will be added to the neighbourhood of v1
+ * weight: edge weight
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int add_weighted_edge (vertex_t *v1, vertex_t *v2, double weight) ;
+
+/* ------------------------------------------------------------------------------
+ * function: graph_add_edges
+ * ------------------------------------------------------------------------------
+ * inserts a batch of edges. The missing vertices are created like in
+ * read_graph (value = id, in the order they first appear in the batch). The
+ * batch is sorted by dense index (radix sort) and repeated pairs and edges
+ * that are already in the graph are dropped. Every new edge has weight 1.
+ * The new edges are stored in a single block and attached to each vertex at
+ * once, sorted by the dense index of the destination.
+ *
+ * g: graph in which the edges will be inserted
+ * src: source vertex id of each edge
+ * dst: destination vertex id of each edge
+ * n: number of edges
+ * flags: bitwise or of the BATCH_* flags
+ *
+ * returns: number of edges inserted or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+long graph_add_edges (graph_t *g, const int *src, const int *dst, size_t n, int flags) ;
+
 /* ------------------------------------------------------------------------------
  * function: remove_edge
  * ------------------------------------------------------------------------------
  * removes the edge from v1 to v2. If the graph is undirected, this function
  * must be called for both ends to remove the edge for each node.
  * Example: you need to remove from A->B and from B->A.
+ * The edge is found in expected constant time when the graph keeps the
+ * edge set.
  *
  * v1: vertex that will have v2 removed from its neighbourhood
  * v2: vertex that will be removed from the neighbourhood of v1
  *
+ * The removed edge still belongs to the graph memory, it must be given
+ * back with release_edge (never with free).
+ *
  * returns: pointer to the removed edge
  * ------------------------------------------------------------------------------ */
 
 edge_t *remove_edge (vertex_t *v1, vertex_t *v2) ;
 
+/* ------------------------------------------------------------------------------
+ * function: release_edge
+ * ------------------------------------------------------------------------------
+ * gives a removed edge back to the graph, so its memory can be reused
+ *
+ * g: graph from which the edge was removed
+ * e: edge returned by remove_edge
+ * ------------------------------------------------------------------------------ */
+
+void release_edge (graph_t *g, edge_t *e) ;
+
 /* ------------------------------------------------------------------------------
  * function: search_edge
  * ------------------------------------------------------------------------------
@@ -165,19 +406,63 @@ void print_graph (graph_t *g, int is_directed) ;
 /* ------------------------------------------------------------------------------
  * function: edge_count
  * ------------------------------------------------------------------------------
- * counts the number of edges in a graph
+ * counts the number of edges in a graph. The count is kept up to date as the
+ * graph changes, so it takes O(1).
  *
  * g: graph to have the edges counted
  * is_directed: indicates if the graph is directed (1) or not (0)
  *
  * The edge_count function behaves differently if the graph is directed
- * or undirected.
+ * or undirected. In undirected graphs every edge is stored in both ends,
+ * except self loops, which are stored once (like in read_graph).
  *
  * returns: the number of edges in that graph
  * ------------------------------------------------------------------------------ */
 
 int edge_count (graph_t *g, int is_directed) ;
 
+/* ------------------------------------------------------------------------------
+ * function: max_degree
+ * ------------------------------------------------------------------------------
+ * gives the largest degree (number of edges in the edges list) in O(1)
+ *
+ * g: graph to be queried
+ *
+ * returns: the largest degree or -1 if the graph is empty
+ * ------------------------------------------------------------------------------ */
+
+int max_degree (graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: min_degree
+ * ------------------------------------------------------------------------------
+ * gives the smallest degree (number of edges in the edges list). It takes
+ * amortized O(1), the bound kept by the graph is only fixed here.
+ *
+ * g: graph to be queried
+ *
+ * returns: the smallest degree or -1 if the graph is empty
+ * ------------------------------------------------------------------------------ */
+
+int min_degree (graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: degree_histogram
+ * ------------------------------------------------------------------------------
+ * copies the number of vertices with each degree. The histogram is kept up
+ * to date as the graph changes, so only the copy takes time.
+ *
+ * g: graph to be queried
+ * histogram: receives the number of vertices with degree 0 to size - 1 (can
+ * be NULL if size is 0)
+ * size: number of entries in histogram
+ *
+ * returns: number of entries the whole histogram needs (max_degree + 1, or 0
+ * if the graph is empty)
+ * ------------------------------------------------------------------------------ */
+
+int degree_histogram (graph_t *g, int *histogram, int size) ;
+
 /* ------------------------------------------------------------------------------
  * function: get_vertex_by_id
  * ------------------------------------------------------------------------------
@@ -194,7 +479,8 @@ vertex_t *get_vertex_by_id (graph_t *g, int id) ;
 /* ------------------------------------------------------------------------------
  * function: search_neighbourhood
  * ------------------------------------------------------------------------------
- * verifies if if v1 has v2 as a neighbour.
+ * verifies if if v1 has v2 as a neighbour. It takes expected constant time
+ * when the graph keeps the edge set.
  *
  * v1: vertex which the neighbourhood will be searched
  * v2: vertex to search in the neighbourhood of v1
@@ -204,6 +490,21 @@ vertex_t *get_vertex_by_id (graph_t *g, int id) ;
 
 int search_neighbourhood (vertex_t *v1, vertex_t *v2) ;
 
+/* ------------------------------------------------------------------------------
+ * function: get_edge
+ * ------------------------------------------------------------------------------
+ * searches for the edge from v1 to v2. It takes expected constant time when
+ * the graph keeps the edge set.
+ *
+ * v1: vertex which the neighbourhood will be searched
+ * v2: vertex to search in the neighbourhood of v1
+ *
+ * returns: pointer to the edge found (the first one, if it is repeated) or
+ * NULL if not found
+ * ------------------------------------------------------------------------------ */
+
+edge_t *get_edge (vertex_t *v1, vertex_t *v2) ;
+
 /* ------------------------------------------------------------------------------
  * function: search_vertex_in_array
  * ------------------------------------------------------------------------------
@@ -228,9 +529,12 @@ int search_vertex_in_array (vertex_t *v, vertex_t **array, int array_size) ;
  * is_directed: indicates if the graph is directed (1) or not (0)
  *
  * The read_graph function behaves differently if the graph is directed
- * or undirected.
+ * or undirected. The input is read in large chunks and every line must
+ * have one or two integers (blank lines are skipped). A line with two
+ * integers can have a third column with the edge weight, in that case the
+ * graph gets GRAPH_WEIGHTED.
  *
- * returns: pointer to the read graph
+ * returns: pointer to the read graph or NULL if the input is badly formatted
  * ------------------------------------------------------------------------------ */
 
 graph_t *read_graph (char *name, FILE *input, int is_directed) ;
@@ -245,17 +549,42 @@ graph_t *read_graph (char *name, FILE *input, int is_directed) ;
  * is_directed: indicates if the graph is directed (1) or not (0)
  *
  * The write_graph function behaves differently if the graph is directed
- * or undirected.
+ * or undirected. It runs in O(V + E) and the output is buffered. The
+ * weights are written as a third column if the graph has GRAPH_WEIGHTED.
  *
  * returns: pointer to the written graph or NULL if an error has ocurred
  * ------------------------------------------------------------------------------ */
 
 graph_t *write_graph (graph_t *g, FILE *output, int is_directed) ;
 
+/* ------------------------------------------------------------------------------
+ * function: graph_snapshot
+ * ------------------------------------------------------------------------------
+ * takes a read only snapshot of the vertices, values and neighbourhoods of
+ * the graph in O(1). The graph keeps its current version as a persistent
+ * trie of vertices: a change copies only the changed vertex and the O(log V)
+ * branches above it, and only while a snapshot still shares them, so the
+ * memory of the snapshots grows with the number of changed vertices. The
+ * snapshots take no locks and never block the writers. While the version is
+ * kept every writer takes the graph lock to update it, so with
+ * GRAPH_CONCURRENT the writers of different stripes wait for each other
+ * there (see snapshot_t). The first call builds the version in O(V + E)
+ * unless the graph was created with GRAPH_SNAPSHOTS. A snapshot stays valid
+ * after destroy_graph.
+ *
+ * g: graph to be read
+ *
+ * returns: pointer to the snapshot (given back with snapshot_release) or NULL
+ * if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+snapshot_t *graph_snapshot (graph_t *g) ;
+
 /* ------------------------------------------------------------------------------
  * function: destroy_graph
  * ------------------------------------------------------------------------------
- * deallocate all the memory used in a graph
+ * deallocate all the memory used in a graph, including the removed vertices
+ * and edges that were not released yet (unless the graph uses GRAPH_NO_POOL)
  *
  * g: graph to have the memory deallocated
  *
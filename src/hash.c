@@ -0,0 +1,181 @@
+#include "hash.h"
+#include "trace.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define HASH_MIN_CAPACITY 16
+
+/* ------------------------------------------------------------------------------ */
+
+static inline unsigned int hash_slot (hash_t *h, uint64_t key)
+{
+  // 64 bit finalizer, spreads sequential ids over the whole table
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+
+  return (unsigned int) key & (h->capacity - 1);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int hash_resize (hash_t *h, unsigned int capacity)
+{
+  hash_entry_t *old = h->entries;
+  unsigned int old_capacity = h->capacity;
+
+  if (!(h->entries = (hash_entry_t *) calloc(capacity, sizeof(hash_entry_t))))
+  {
+    h->entries = old;
+    return 0;
+  }
+
+  h->capacity = capacity;
+
+  for (unsigned int i = 0; i < old_capacity; ++i)
+    if (old[i].value) // moves every entry to its new slot
+    {
+      unsigned int slot = hash_slot(h, old[i].key);
+
+      while (h->entries[slot].value)
+        slot = (slot + 1) & (capacity - 1);
+
+      h->entries[slot] = old[i];
+    }
+
+  free(old);
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void hash_init (hash_t *h)
+{
+  if (!h)
+    return;
+
+  h->entries = NULL;
+  h->capacity = h->count = 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int hash_reserve (hash_t *h, unsigned int count)
+{
+  if (!h)
+    return 0;
+
+  unsigned int capacity = h->capacity ? h->capacity : HASH_MIN_CAPACITY;
+
+  while (capacity < 2 * (uint64_t) count)
+    capacity *= 2;
+
+  return capacity == h->capacity || hash_resize(h, capacity);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int hash_insert (hash_t *h, uint64_t key, void *value)
+{
+  if (!h || !value)
+    return 0;
+
+  // keeps the load factor under 1/2
+  if (2 * (h->count + 1) > h->capacity)
+    if (!hash_resize(h, h->capacity ? 2 * h->capacity : HASH_MIN_CAPACITY))
+      return 0;
+
+  unsigned int slot = hash_slot(h, key);
+
+  while (h->entries[slot].value)
+  {
+    if (h->entries[slot].key == key) // if the key already exists
+    {
+      h->entries[slot].value = value;
+      return 1;
+    }
+
+    slot = (slot + 1) & (h->capacity - 1);
+  }
+
+  h->entries[slot].key = key;
+  h->entries[slot].value = value;
+  h->count++;
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void *hash_search (hash_t *h, uint64_t key)
+{
+  if (!h || !h->count)
+    return NULL;
+
+  unsigned int slot = hash_slot(h, key);
+
+  while (h->entries[slot].value)
+  {
+    TRACE_COUNT(TRACE_PROBES, 1);
+
+    if (h->entries[slot].key == key) // if the key is found
+      return h->entries[slot].value;
+
+    slot = (slot + 1) & (h->capacity - 1);
+  }
+
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void *hash_remove (hash_t *h, uint64_t key)
+{
+  if (!h || !h->count)
+    return NULL;
+
+  unsigned int mask = h->capacity - 1;
+  unsigned int slot = hash_slot(h, key);
+  void *value;
+
+  while (h->entries[slot].key != key)
+  {
+    if (!h->entries[slot].value) // if the key is not in the table
+      return NULL;
+
+    slot = (slot + 1) & mask;
+  }
+
+  if (!(value = h->entries[slot].value))
+    return NULL;
+
+  h->count--;
+
+  // backward shift deletion: pulls back the entries of the same probe chain,
+  // so the table never needs tombstones
+  for (unsigned int next = (slot + 1) & mask; h->entries[next].value; next = (next + 1) & mask)
+  {
+    unsigned int home = hash_slot(h, h->entries[next].key);
+
+    // moves the entry only if its home slot is not between the hole and it
+    if (((next - home) & mask) >= ((next - slot) & mask))
+    {
+      h->entries[slot] = h->entries[next];
+      slot = next;
+    }
+  }
+
+  h->entries[slot].value = NULL;
+  return value;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void hash_destroy (hash_t *h)
+{
+  if (!h)
+    return;
+
+  free(h->entries);
+  hash_init(h);
+}
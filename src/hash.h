@@ -0,0 +1,121 @@
+#ifndef __HASH__
+#define __HASH__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct hash_t hash_t ;
+typedef struct hash_entry_t hash_entry_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: hash entry
+ * ------------------------------------------------------------------------------
+ * key: entry key
+ * value: entry value (NULL marks an empty slot)
+ * ------------------------------------------------------------------------------ */
+
+struct hash_entry_t
+{
+  uint64_t key ;
+  void *value ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: hash table
+ * ------------------------------------------------------------------------------
+ * open addressing table with linear probing. The capacity is always a power
+ * of two and the table grows when it gets half full.
+ *
+ * entries: table slots
+ * capacity: number of slots
+ * count: number of stored entries
+ * ------------------------------------------------------------------------------ */
+
+struct hash_t
+{
+  hash_entry_t *entries ;
+  unsigned int capacity ;
+  unsigned int count ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: hash_init
+ * ------------------------------------------------------------------------------
+ * initializes an empty hash table (no memory is allocated until the first
+ * insertion)
+ *
+ * h: hash table to be initialized
+ * ------------------------------------------------------------------------------ */
+
+void hash_init (hash_t *h) ;
+
+/* ------------------------------------------------------------------------------
+ * function: hash_reserve
+ * ------------------------------------------------------------------------------
+ * grows the table so it can hold count entries without growing again
+ *
+ * h: hash table to be grown
+ * count: number of entries
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int hash_reserve (hash_t *h, unsigned int count) ;
+
+/* ------------------------------------------------------------------------------
+ * function: hash_insert
+ * ------------------------------------------------------------------------------
+ * inserts a key in the hash table, replacing the value if the key exists
+ *
+ * h: hash table in which the key will be inserted
+ * key: key to be inserted
+ * value: value associated to the key (must not be NULL)
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int hash_insert (hash_t *h, uint64_t key, void *value) ;
+
+/* ------------------------------------------------------------------------------
+ * function: hash_search
+ * ------------------------------------------------------------------------------
+ * searches for a key in the hash table
+ *
+ * h: hash table in which the key will be searched
+ * key: key to be found
+ *
+ * returns: value associated to the key or NULL if not found
+ * ------------------------------------------------------------------------------ */
+
+void *hash_search (hash_t *h, uint64_t key) ;
+
+/* ------------------------------------------------------------------------------
+ * function: hash_remove
+ * ------------------------------------------------------------------------------
+ * removes a key from the hash table
+ *
+ * h: hash table from which the key will be removed
+ * key: key to be removed
+ *
+ * returns: value that was associated to the key or NULL if not found
+ * ------------------------------------------------------------------------------ */
+
+void *hash_remove (hash_t *h, uint64_t key) ;
+
+/* ------------------------------------------------------------------------------
+ * function: hash_destroy
+ * ------------------------------------------------------------------------------
+ * deallocate the memory used by the hash table (the values are not touched)
+ *
+ * h: hash table to have the memory deallocated
+ * ------------------------------------------------------------------------------ */
+
+void hash_destroy (hash_t *h) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,148 @@
+#include "heap.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define HEAP_LINE 64
+
+/* ------------------------------------------------------------------------------ */
+
+// moves a node up until its parent has a smaller or equal key
+static void sift_up (heap_t *h, int i, heap_node_t node)
+{
+  while (i > 0)
+  {
+    int parent = (i - 1) / h->arity;
+
+    if (h->nodes[parent].key <= node.key)
+      break;
+
+    h->nodes[i] = h->nodes[parent];
+    h->pos[h->nodes[i].item] = i;
+    i = parent;
+  }
+
+  h->nodes[i] = node;
+  h->pos[node.item] = i;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// moves a node down until its children have greater or equal keys
+static void sift_down (heap_t *h, int i, heap_node_t node)
+{
+  int first;
+
+  while ((first = h->arity * i + 1) < h->size)
+  {
+    int last = first + h->arity < h->size ? first + h->arity : h->size;
+    int child = first;
+
+    for (int c = first + 1; c < last; ++c) // smallest child
+      if (h->nodes[c].key < h->nodes[child].key)
+        child = c;
+
+    if (node.key <= h->nodes[child].key)
+      break;
+
+    h->nodes[i] = h->nodes[child];
+    h->pos[h->nodes[i].item] = i;
+    i = child;
+  }
+
+  h->nodes[i] = node;
+  h->pos[node.item] = i;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int heap_init (heap_t *h, int capacity, int arity)
+{
+  if (!h || capacity < 0 || arity < 2)
+    return 0;
+
+  // the children of the root start at index 1, so shifting the array by
+  // arity - 1 nodes makes every group of children start at a cache line
+  // (when a group fills whole lines)
+  size_t shift = arity - 1;
+  size_t size = (capacity + shift) * sizeof(heap_node_t) + HEAP_LINE;
+
+  h->memory = malloc(size);
+  h->pos = (int *) malloc((capacity + 1) * sizeof(int));
+
+  if (!h->memory || !h->pos)
+  {
+    free(h->memory);
+    free(h->pos);
+    h->memory = NULL;
+    h->pos = NULL;
+    return 0;
+  }
+
+  // first cache line boundary of the block
+  char *aligned = (char *) (((size_t) h->memory + HEAP_LINE - 1) & ~((size_t) HEAP_LINE - 1));
+
+  h->nodes = (heap_node_t *) aligned + shift;
+  h->size = 0;
+  h->capacity = capacity;
+  h->arity = arity;
+
+  for (int i = 0; i < capacity; ++i)
+    h->pos[i] = -1;
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int heap_update (heap_t *h, int item, double key)
+{
+  if (!h || item < 0 || item >= h->capacity)
+    return 0;
+
+  heap_node_t node = { key, item };
+  int i = h->pos[item];
+
+  if (i < 0) // new item
+    i = h->size++;
+  else if (h->nodes[i].key <= key)
+    return 0;
+
+  sift_up(h, i, node);
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int heap_pop (heap_t *h, double *key)
+{
+  if (!h || !h->size)
+    return -1;
+
+  heap_node_t top = h->nodes[0];
+
+  h->pos[top.item] = -1;
+
+  // the last node takes the place of the root
+  if (--h->size)
+    sift_down(h, 0, h->nodes[h->size]);
+
+  if (key)
+    *key = top.key;
+
+  return top.item;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void heap_destroy (heap_t *h)
+{
+  if (!h)
+    return;
+
+  free(h->memory);
+  free(h->pos);
+  h->memory = NULL;
+  h->pos = NULL;
+  h->nodes = NULL;
+  h->size = h->capacity = 0;
+}
@@ -0,0 +1,110 @@
+#ifndef __HEAP__
+#define __HEAP__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stdlib.h>
+
+/* ------------------------------------------------------------------------------ */
+
+#define HEAP_ARITY 4
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct heap_t heap_t ;
+typedef struct heap_node_t heap_node_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: heap node
+ * ------------------------------------------------------------------------------
+ * key: node key (priority)
+ * item: item stored in the node
+ * ------------------------------------------------------------------------------ */
+
+struct heap_node_t
+{
+  double key ;
+  int item ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: heap
+ * ------------------------------------------------------------------------------
+ * array based d-ary min heap of items from 0 to capacity - 1, with
+ * decrease-key. The keys are stored in the nodes, so a sift only touches the
+ * heap array, and the array is aligned so the children of a node share the
+ * same cache lines.
+ *
+ * nodes: heap array (the children of i are arity * i + 1 to arity * i + arity)
+ * pos: position of each item in nodes (-1 if it is not in the heap)
+ * memory: allocated block that holds nodes
+ * size: number of items in the heap
+ * capacity: number of items
+ * arity: number of children of each node
+ * ------------------------------------------------------------------------------ */
+
+struct heap_t
+{
+  heap_node_t *nodes ;
+  int *pos ;
+  void *memory ;
+  int size ;
+  int capacity ;
+  int arity ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: heap_init
+ * ------------------------------------------------------------------------------
+ * initializes an empty heap
+ *
+ * h: heap to be initialized
+ * capacity: number of items (the items go from 0 to capacity - 1)
+ * arity: number of children of each node (HEAP_ARITY is a good default)
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int heap_init (heap_t *h, int capacity, int arity) ;
+
+/* ------------------------------------------------------------------------------
+ * function: heap_update
+ * ------------------------------------------------------------------------------
+ * inserts an item or decreases its key if it is already in the heap
+ *
+ * h: heap in which the item will be inserted
+ * item: item to be inserted
+ * key: item key
+ *
+ * returns: 1 if the item was inserted or its key decreased, 0 otherwise (the
+ * item is in the heap with a smaller or equal key, or it is out of range)
+ * ------------------------------------------------------------------------------ */
+
+int heap_update (heap_t *h, int item, double key) ;
+
+/* ------------------------------------------------------------------------------
+ * function: heap_pop
+ * ------------------------------------------------------------------------------
+ * removes the item with the smallest key
+ *
+ * h: heap from which the item will be removed
+ * key: receives the key of the item (can be NULL)
+ *
+ * returns: the removed item or -1 if the heap is empty
+ * ------------------------------------------------------------------------------ */
+
+int heap_pop (heap_t *h, double *key) ;
+
+/* ------------------------------------------------------------------------------
+ * function: heap_destroy
+ * ------------------------------------------------------------------------------
+ * deallocate the memory used by the heap
+ *
+ * h: heap to be destroyed
+ * ------------------------------------------------------------------------------ */
+
+void heap_destroy (heap_t *h) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -31,6 +31,9 @@ int main (int argc, char **argv)
 
   // undirected graph
   graph_t *g1 = read_graph("und_graph", fp, 0);
+  if (!g1)
+    exit(1);
+
   printf("-------------------------\n");
   printf("undirected graph example\n");
   printf("-------------------------\n");
@@ -44,6 +47,9 @@ int main (int argc, char **argv)
 
   // directed graph
   graph_t *g2 = read_graph("d_graph", fp, 1);
+  if (!g2)
+    exit(1);
+
   printf("\n-------------------------\n");
   printf("directed graph example\n");
   printf("-------------------------\n");
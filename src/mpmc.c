@@ -0,0 +1,102 @@
+#include "mpmc.h"
+
+/* ------------------------------------------------------------------------------ */
+
+int mpmc_init (mpmc_t *q, size_t capacity)
+{
+  if (!q)
+    return 0;
+
+  size_t size = 2;
+
+  while (size < capacity)
+    size *= 2;
+
+  if (!(q->cells = (mpmc_cell_t *) malloc(size * sizeof(mpmc_cell_t))))
+    return 0;
+
+  // every cell starts free for the producer of its position
+  for (size_t i = 0; i < size; ++i)
+    q->cells[i].sequence = i;
+
+  q->mask = size - 1;
+  q->head = q->tail = 0;
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int mpmc_push (mpmc_t *q, int value)
+{
+  size_t pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+  mpmc_cell_t *cell;
+
+  for (;;)
+  {
+    cell = &(q->cells[pos & q->mask]);
+
+    size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    long diff = (long) (sequence - pos);
+
+    if (!diff) // free, tries to claim it (pos is reloaded on failure)
+    {
+      if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    }
+    else if (diff < 0) // still holds the value of the previous lap
+      return 0;
+    else // another producer took pos
+      pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+  }
+
+  cell->value = value;
+  // hands the cell to the consumer of pos
+  __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int mpmc_pop (mpmc_t *q, int *value)
+{
+  size_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+  mpmc_cell_t *cell;
+
+  for (;;)
+  {
+    cell = &(q->cells[pos & q->mask]);
+
+    size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+    long diff = (long) (sequence - (pos + 1));
+
+    if (!diff) // holds a value, tries to claim it
+    {
+      if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    }
+    else if (diff < 0) // not written yet
+      return 0;
+    else // another consumer took pos
+      pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+  }
+
+  *value = cell->value;
+  // frees the cell for the producer of the next lap
+  __atomic_store_n(&cell->sequence, pos + q->mask + 1, __ATOMIC_RELEASE);
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void mpmc_destroy (mpmc_t *q)
+{
+  if (!q)
+    return;
+
+  free(q->cells);
+  q->cells = NULL;
+  q->mask = 0;
+}
@@ -0,0 +1,107 @@
+#ifndef __MPMC__
+#define __MPMC__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/* ------------------------------------------------------------------------------ */
+
+#define MPMC_LINE 64
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct mpmc_t mpmc_t ;
+typedef struct mpmc_cell_t mpmc_cell_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: mpmc cell
+ * ------------------------------------------------------------------------------
+ * sequence: position that the cell waits for (pos when it is free for the
+ * producer of pos, pos + 1 when it holds the value for the consumer of pos)
+ * value: stored value
+ * ------------------------------------------------------------------------------ */
+
+struct mpmc_cell_t
+{
+  size_t sequence ;
+  int value ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: mpmc queue
+ * ------------------------------------------------------------------------------
+ * bounded lock free queue of integers (vertex ids, dense indices) for many
+ * producers and many consumers. It is a ring buffer where every cell has a
+ * sequence number: a thread claims a position with a compare and swap and the
+ * sequence of the cell tells if it is ready, so there are no locks and the
+ * producers and consumers only share the cells they use. Unlike queue_t, the
+ * elements are copied in and out and nothing is allocated per element.
+ *
+ * cells: ring buffer (capacity cells)
+ * mask: capacity - 1 (the capacity is a power of two)
+ * head: next position to be written (on its own cache line)
+ * tail: next position to be read (on its own cache line)
+ * ------------------------------------------------------------------------------ */
+
+struct mpmc_t
+{
+  mpmc_cell_t *cells ;
+  size_t mask ;
+  size_t head __attribute__((aligned(MPMC_LINE))) ;
+  size_t tail __attribute__((aligned(MPMC_LINE))) ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: mpmc_init
+ * ------------------------------------------------------------------------------
+ * initializes an empty queue (not thread safe)
+ *
+ * q: queue to be initialized
+ * capacity: number of elements (rounded up to a power of two, at least 2)
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int mpmc_init (mpmc_t *q, size_t capacity) ;
+
+/* ------------------------------------------------------------------------------
+ * function: mpmc_push
+ * ------------------------------------------------------------------------------
+ * inserts an element at the end of the queue, it never waits
+ *
+ * q: queue in which the element will be inserted
+ * value: element to be inserted
+ *
+ * returns: 1 if the element was inserted or 0 if the queue is full
+ * ------------------------------------------------------------------------------ */
+
+int mpmc_push (mpmc_t *q, int value) ;
+
+/* ------------------------------------------------------------------------------
+ * function: mpmc_pop
+ * ------------------------------------------------------------------------------
+ * removes the element at the beginning of the queue, it never waits
+ *
+ * q: queue from which the element will be removed
+ * value: receives the removed element
+ *
+ * returns: 1 if an element was removed or 0 if the queue is empty
+ * ------------------------------------------------------------------------------ */
+
+int mpmc_pop (mpmc_t *q, int *value) ;
+
+/* ------------------------------------------------------------------------------
+ * function: mpmc_destroy
+ * ------------------------------------------------------------------------------
+ * deallocate the memory used by the queue (not thread safe)
+ *
+ * q: queue to be destroyed
+ * ------------------------------------------------------------------------------ */
+
+void mpmc_destroy (mpmc_t *q) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,875 @@
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "parallel.h"
+
+/* ------------------------------------------------------------------------------ */
+
+// direction switching thresholds (Beamer et al.)
+#define ALPHA 14
+#define BETA 24
+
+// work units taken by a thread at once
+#define TOP_DOWN_CHUNK 256
+#define BOTTOM_UP_CHUNK 4096 // multiple of 64, so bitmap words have one owner
+#define LOCAL_BUFFER 4096
+
+#define TOP_DOWN 0
+#define BOTTOM_UP 1
+
+#define PAGERANK_CHUNK 1024
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct barrier_t barrier_t ;
+typedef struct bfs_state_t bfs_state_t ;
+typedef struct rank_state_t rank_state_t ;
+typedef struct load_range_t load_range_t ;
+
+// reusable barrier (pthread_barrier_t is optional in POSIX), the number of
+// threads can be lowered while some of them are waiting
+struct barrier_t
+{
+  pthread_mutex_t lock ;
+  pthread_cond_t cond ;
+  int count ;
+  int waiting ;
+  unsigned int generation ;
+} ;
+
+// state shared by all the threads of one search
+struct bfs_state_t
+{
+  const csr_t *out, *in ;
+  int *depth ;
+  uint64_t *visited ;
+  uint64_t *frontier_bits, *next_bits ;
+  int *frontier, *next ;
+  size_t frontier_size, next_size ;
+  size_t cursor ;
+  size_t unexplored ; // edges of the vertices not visited yet
+  size_t next_edges ; // edges of the next frontier
+  size_t found ; // vertices found by the current step
+  size_t reached ;
+  int level ;
+  int mode ;
+  int done ;
+  int threads ;
+  int error ;
+  barrier_t barrier ;
+} ;
+
+// state shared by all the threads of one pagerank, the scores and the
+// contributions (score / out-degree) have two buffers: the current iteration
+// reads one and writes the other
+struct rank_state_t
+{
+  const csr_t *out, *in ;
+  const double *teleport ;
+  double *rank, *next ;
+  double *contrib, *next_contrib ;
+  double *dangling ; // rank without out-edges found by each thread
+  double *change ; // sum of the absolute changes found by each thread
+  double damping, tolerance, lost ;
+  size_t cursor ;
+  int worker ; // ids given to the threads
+  int iterations, max_iterations ;
+  int done ;
+  int threads ;
+  barrier_t barrier ;
+} ;
+
+// one byte range of a file read by read_graph_parallel, and what was parsed
+struct load_range_t
+{
+  pthread_t thread ;
+  int started ;
+  const char *begin, *end ;
+  int *src, *dst ; // dst == src for the single id lines
+  unsigned char *single ;
+  double *weight ; // only allocated once a weight is found
+  size_t count, capacity ;
+  size_t lines ;
+  int error ;
+} ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int barrier_init (barrier_t *b, int count)
+{
+  b->count = count;
+  b->waiting = 0;
+  b->generation = 0;
+
+  if (pthread_mutex_init(&b->lock, NULL))
+    return 0;
+
+  if (pthread_cond_init(&b->cond, NULL))
+  {
+    pthread_mutex_destroy(&b->lock);
+    return 0;
+  }
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// returns 1 in the last thread to arrive and 0 in the others
+static int barrier_wait (barrier_t *b)
+{
+  int last = 0;
+
+  pthread_mutex_lock(&b->lock);
+
+  if (++b->waiting >= b->count)
+  {
+    b->waiting = 0;
+    b->generation++;
+    last = 1;
+    pthread_cond_broadcast(&b->cond);
+  }
+  else
+  {
+    unsigned int generation = b->generation;
+
+    while (generation == b->generation)
+      pthread_cond_wait(&b->cond, &b->lock);
+  }
+
+  pthread_mutex_unlock(&b->lock);
+  return last;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void barrier_destroy (barrier_t *b)
+{
+  pthread_cond_destroy(&b->cond);
+  pthread_mutex_destroy(&b->lock);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static inline int test_bit (const uint64_t *bits, int i)
+{
+  return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// sets the bit atomically, returns 1 if this call changed it
+static inline int claim_bit (uint64_t *bits, int i)
+{
+  uint64_t mask = (uint64_t) 1 << (i & 63);
+
+  if (__atomic_load_n(&bits[i >> 6], __ATOMIC_RELAXED) & mask)
+    return 0;
+
+  return !(__atomic_fetch_or(&bits[i >> 6], mask, __ATOMIC_RELAXED) & mask);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// moves a thread buffer to the end of the next frontier
+static void flush_buffer (bfs_state_t *s, int *buffer, int *used)
+{
+  size_t pos = __atomic_fetch_add(&s->next_size, *used, __ATOMIC_RELAXED);
+
+  memcpy(s->next + pos, buffer, *used * sizeof(int));
+  *used = 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void top_down_step (bfs_state_t *s, int *buffer, size_t *found, size_t *edges)
+{
+  const csr_t *c = s->out;
+  int used = 0;
+  size_t start;
+
+  while ((start = __atomic_fetch_add(&s->cursor, TOP_DOWN_CHUNK, __ATOMIC_RELAXED)) < s->frontier_size)
+  {
+    size_t end = start + TOP_DOWN_CHUNK < s->frontier_size ? start + TOP_DOWN_CHUNK : s->frontier_size;
+
+    for (size_t f = start; f < end; ++f)
+    {
+      int u = s->frontier[f];
+
+      for (size_t e = c->offsets[u]; e < c->offsets[u + 1]; ++e)
+      {
+        int v = c->targets[e];
+
+        if (claim_bit(s->visited, v))
+        {
+          s->depth[v] = s->level + 1;
+          (*found)++;
+          *edges += csr_degree(c, v);
+
+          if (used == LOCAL_BUFFER)
+            flush_buffer(s, buffer, &used);
+          buffer[used++] = v;
+        }
+      }
+    }
+  }
+
+  if (used)
+    flush_buffer(s, buffer, &used);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void bottom_up_step (bfs_state_t *s, size_t *found, size_t *edges)
+{
+  const csr_t *c = s->in;
+  size_t start, size = s->out->size;
+
+  while ((start = __atomic_fetch_add(&s->cursor, BOTTOM_UP_CHUNK, __ATOMIC_RELAXED)) < size)
+  {
+    size_t end = start + BOTTOM_UP_CHUNK < size ? start + BOTTOM_UP_CHUNK : size;
+
+    // the chunk owns its bitmap words, no atomic operation is needed
+    for (size_t v = start; v < end; ++v)
+    {
+      if (test_bit(s->visited, v))
+        continue;
+
+      for (size_t e = c->offsets[v]; e < c->offsets[v + 1]; ++e)
+        if (test_bit(s->frontier_bits, c->targets[e])) // found a parent
+        {
+          s->visited[v >> 6] |= (uint64_t) 1 << (v & 63);
+          s->next_bits[v >> 6] |= (uint64_t) 1 << (v & 63);
+          s->depth[v] = s->level + 1;
+          (*found)++;
+          *edges += csr_degree(s->out, v);
+          break;
+        }
+    }
+  }
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// runs between two steps on a single thread: picks the direction of the next
+// step and converts the frontier to the representation it needs
+static void next_level (bfs_state_t *s, size_t found)
+{
+  size_t words = (s->out->size + 63) / 64;
+  int mode = s->mode;
+
+  s->reached += found;
+  s->found = 0;
+  s->unexplored -= s->next_edges < s->unexplored ? s->next_edges : s->unexplored;
+  s->level++;
+
+  if (!found)
+  {
+    s->done = 1;
+    return;
+  }
+
+  if (mode == TOP_DOWN && s->next_edges > s->unexplored / ALPHA)
+    mode = BOTTOM_UP;
+  else if (mode == BOTTOM_UP && found < (size_t) s->out->size / BETA)
+    mode = TOP_DOWN;
+
+  if (s->mode == TOP_DOWN) // the new frontier is in next
+  {
+    int *aux = s->frontier;
+
+    s->frontier = s->next;
+    s->next = aux;
+    s->frontier_size = s->next_size;
+
+    if (mode == BOTTOM_UP)
+    {
+      memset(s->frontier_bits, 0, words * sizeof(uint64_t));
+      for (size_t f = 0; f < s->frontier_size; ++f)
+        s->frontier_bits[s->frontier[f] >> 6] |= (uint64_t) 1 << (s->frontier[f] & 63);
+    }
+  }
+  else // the new frontier is in next_bits
+  {
+    uint64_t *aux = s->frontier_bits;
+
+    s->frontier_bits = s->next_bits;
+    s->next_bits = aux;
+
+    if (mode == TOP_DOWN)
+    {
+      s->frontier_size = 0;
+      for (size_t w = 0; w < words; ++w)
+        for (uint64_t bits = s->frontier_bits[w]; bits; bits &= bits - 1)
+          s->frontier[s->frontier_size++] = (int) (w * 64 + __builtin_ctzll(bits));
+    }
+  }
+
+  if (mode == BOTTOM_UP)
+    memset(s->next_bits, 0, words * sizeof(uint64_t));
+
+  s->mode = mode;
+  s->next_size = 0;
+  s->next_edges = 0;
+  s->cursor = 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void *bfs_worker (void *arg)
+{
+  bfs_state_t *s = (bfs_state_t *) arg;
+  int *buffer = (int *) malloc(LOCAL_BUFFER * sizeof(int));
+  size_t found, edges;
+
+  if (!buffer)
+    __atomic_store_n(&s->error, 1, __ATOMIC_RELAXED);
+
+  barrier_wait(&s->barrier);
+
+  while (!s->done && !s->error)
+  {
+    found = edges = 0;
+
+    if (s->mode == TOP_DOWN)
+      top_down_step(s, buffer, &found, &edges);
+    else
+      bottom_up_step(s, &found, &edges);
+
+    __atomic_fetch_add(&s->next_edges, edges, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->found, found, __ATOMIC_RELAXED);
+
+    // the last thread to arrive prepares the next level
+    if (barrier_wait(&s->barrier))
+      next_level(s, s->found);
+
+    barrier_wait(&s->barrier);
+  }
+
+  free(buffer);
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int parallel_bfs (csr_t *out, csr_t *in, int source, int *depth, int threads)
+{
+  if (!out || !depth || source < 0 || source >= out->size)
+    return -1;
+
+  if (threads < 1)
+    threads = 1;
+
+  size_t words = (out->size + 63) / 64 + 1;
+  bfs_state_t s;
+  pthread_t *ids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+  int started = 0;
+
+  memset(&s, 0, sizeof(bfs_state_t));
+  s.out = out;
+  s.in = in ? in : out;
+  s.depth = depth;
+  s.threads = threads;
+  s.visited = (uint64_t *) calloc(words, sizeof(uint64_t));
+  s.frontier_bits = (uint64_t *) calloc(words, sizeof(uint64_t));
+  s.next_bits = (uint64_t *) calloc(words, sizeof(uint64_t));
+  s.frontier = (int *) malloc((out->size + 1) * sizeof(int));
+  s.next = (int *) malloc((out->size + 1) * sizeof(int));
+
+  if (!ids || !s.visited || !s.frontier_bits || !s.next_bits || !s.frontier || !s.next ||
+      !barrier_init(&s.barrier, threads))
+    s.error = 1;
+
+  if (!s.error)
+  {
+    for (int i = 0; i < out->size; ++i)
+      depth[i] = -1;
+
+    depth[source] = 0;
+    s.visited[source >> 6] |= (uint64_t) 1 << (source & 63);
+    s.frontier[0] = source;
+    s.frontier_size = 1;
+    s.unexplored = out->edges - csr_degree(out, source);
+    s.mode = TOP_DOWN;
+    s.reached = 1;
+
+    // the calling thread is the worker 0
+    for (started = 1; started < threads; ++started)
+      if (pthread_create(&ids[started], NULL, bfs_worker, &s))
+        break;
+
+    if (started < threads) // the started threads are told to give up
+    {
+      pthread_mutex_lock(&s.barrier.lock);
+      s.error = 1;
+      s.barrier.count = started;
+      pthread_mutex_unlock(&s.barrier.lock);
+    }
+
+    bfs_worker(&s);
+
+    for (int i = 1; i < started; ++i)
+      pthread_join(ids[i], NULL);
+
+    barrier_destroy(&s.barrier);
+  }
+
+  free(ids);
+  free(s.visited);
+  free(s.frontier_bits);
+  free(s.next_bits);
+  free(s.frontier);
+  free(s.next);
+
+  return s.error ? -1 : (int) s.reached;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// sum of the contributions of the in-neighbours, four independent sums so the
+// additions do not wait for each other
+static inline double pull_sum (const double *contrib, const int *targets, size_t start, size_t end)
+{
+  double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t e = start;
+
+  for (; e + 4 <= end; e += 4)
+  {
+    s0 += contrib[targets[e]];
+    s1 += contrib[targets[e + 1]];
+    s2 += contrib[targets[e + 2]];
+    s3 += contrib[targets[e + 3]];
+  }
+
+  for (; e < end; ++e)
+    s0 += contrib[targets[e]];
+
+  return (s0 + s1) + (s2 + s3);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// runs between two iterations on a single thread
+static void next_iteration (rank_state_t *s)
+{
+  double change = 0, dangling = 0;
+  double *aux;
+
+  for (int t = 0; t < s->threads; ++t)
+  {
+    change += s->change[t];
+    dangling += s->dangling[t];
+  }
+
+  aux = s->rank;
+  s->rank = s->next;
+  s->next = aux;
+  aux = s->contrib;
+  s->contrib = s->next_contrib;
+  s->next_contrib = aux;
+
+  s->lost = dangling;
+  s->cursor = 0;
+  s->done = ++s->iterations >= s->max_iterations || change < s->tolerance;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void *rank_worker (void *arg)
+{
+  rank_state_t *s = (rank_state_t *) arg;
+  const csr_t *in = s->in;
+  size_t start, size = in->size;
+  int id = __atomic_fetch_add(&s->worker, 1, __ATOMIC_RELAXED);
+
+  while (!s->done)
+  {
+    double change = 0, dangling = 0;
+    // the teleports and the rank of the vertices without out-edges
+    double spread = 1 - s->damping + s->damping * s->lost;
+
+    while ((start = __atomic_fetch_add(&s->cursor, PAGERANK_CHUNK, __ATOMIC_RELAXED)) < size)
+    {
+      size_t end = start + PAGERANK_CHUNK < size ? start + PAGERANK_CHUNK : size;
+
+      for (size_t v = start; v < end; ++v)
+      {
+        double r = spread * s->teleport[v] +
+                   s->damping * pull_sum(s->contrib, in->targets, in->offsets[v], in->offsets[v + 1]);
+        int degree = csr_degree(s->out, v);
+
+        change += fabs(r - s->rank[v]);
+        s->next[v] = r;
+        s->next_contrib[v] = degree ? r / degree : 0;
+        if (!degree)
+          dangling += r;
+      }
+    }
+
+    s->change[id] = change;
+    s->dangling[id] = dangling;
+
+    // the last thread to arrive prepares the next iteration
+    if (barrier_wait(&s->barrier))
+      next_iteration(s);
+
+    barrier_wait(&s->barrier);
+  }
+
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int personalized_pagerank (csr_t *out, csr_t *in, const double *personalization, double *rank,
+                           double damping, double tolerance, int max_iterations, int threads)
+{
+  if (!out || !rank || !out->size || damping < 0 || damping > 1 || max_iterations < 0)
+    return -1;
+
+  if (threads < 1)
+    threads = 1;
+
+  csr_t *transposed = in ? NULL : csr_transpose(out);
+  double total = 0;
+  rank_state_t s;
+  pthread_t *ids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+  double *teleport = (double *) malloc(out->size * sizeof(double));
+  double *buffers = (double *) malloc(3 * out->size * sizeof(double));
+  double *partials = (double *) calloc(2 * threads, sizeof(double));
+  int started = 1, error = !ids || !teleport || !buffers || !partials || (!in && !transposed);
+
+  for (int i = 0; !error && i < out->size; ++i)
+    if (personalization && personalization[i] < 0)
+      error = 1;
+    else
+      total += personalization ? personalization[i] : 1;
+
+  if (!error && total > 0 && barrier_init(&s.barrier, threads))
+  {
+    memset(&s, 0, offsetof(rank_state_t, barrier));
+    s.out = out;
+    s.in = in ? in : transposed;
+    s.teleport = teleport;
+    s.rank = rank;
+    s.next = buffers;
+    s.contrib = buffers + out->size;
+    s.next_contrib = buffers + 2 * out->size;
+    s.dangling = partials;
+    s.change = partials + threads;
+    s.damping = damping;
+    s.tolerance = tolerance;
+    s.max_iterations = max_iterations;
+    s.done = !max_iterations;
+    s.threads = threads;
+
+    // starts from the teleport vector
+    for (int i = 0; i < out->size; ++i)
+    {
+      int degree = csr_degree(out, i);
+
+      rank[i] = teleport[i] = (personalization ? personalization[i] : 1) / total;
+      s.contrib[i] = degree ? rank[i] / degree : 0;
+      if (!degree)
+        s.lost += rank[i];
+    }
+
+    // the calling thread is the worker 0
+    for (started = 1; started < threads; ++started)
+      if (pthread_create(&ids[started], NULL, rank_worker, &s))
+        break;
+
+    if (started < threads) // the barrier only waits for the started threads
+    {
+      pthread_mutex_lock(&s.barrier.lock);
+      s.barrier.count = started;
+      s.threads = started;
+      pthread_mutex_unlock(&s.barrier.lock);
+    }
+
+    rank_worker(&s);
+
+    for (int i = 1; i < started; ++i)
+      pthread_join(ids[i], NULL);
+
+    barrier_destroy(&s.barrier);
+
+    if (s.rank != rank) // the last scores are in a work buffer
+      memcpy(rank, s.rank, out->size * sizeof(double));
+  }
+  else
+    error = 1;
+
+  free(ids);
+  free(teleport);
+  free(buffers);
+  free(partials);
+  csr_destroy(transposed);
+
+  return error ? -1 : s.iterations;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int pagerank (csr_t *out, csr_t *in, double *rank, double damping, double tolerance, int max_iterations, int threads)
+{
+  return personalized_pagerank(out, in, NULL, rank, damping, tolerance, max_iterations, threads);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// makes room for one more line in the buffers of a range
+static int range_grow (load_range_t *r)
+{
+  if (r->count < r->capacity)
+    return 1;
+
+  size_t capacity = r->capacity ? 2 * r->capacity : 4096;
+  int *src = (int *) realloc(r->src, capacity * sizeof(int));
+
+  if (src)
+    r->src = src;
+
+  int *dst = (int *) realloc(r->dst, capacity * sizeof(int));
+
+  if (dst)
+    r->dst = dst;
+
+  unsigned char *single = (unsigned char *) realloc(r->single, capacity);
+
+  if (single)
+    r->single = single;
+
+  double *weight = r->weight ? (double *) realloc(r->weight, capacity * sizeof(double)) : NULL;
+
+  if (weight)
+    r->weight = weight;
+
+  if (!src || !dst || !single || (r->weight && !weight))
+    return 0;
+
+  r->capacity = capacity;
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// parses one range of the file
+static void *load_worker (void *arg)
+{
+  load_range_t *r = (load_range_t *) arg;
+  reader_t reader;
+  int rd, ids[2];
+  double weight;
+
+  reader_init_memory(&reader, r->begin, r->end - r->begin);
+
+  while ((rd = reader_edge(&reader, ids, &weight)) > 0)
+  {
+    if (!range_grow(r))
+    {
+      rd = -1;
+      break;
+    }
+
+    if (rd == 3 && !r->weight) // the earlier lines had weight 1
+    {
+      if (!(r->weight = (double *) malloc(r->capacity * sizeof(double))))
+      {
+        rd = -1;
+        break;
+      }
+
+      for (size_t i = 0; i < r->count; ++i)
+        r->weight[i] = 1.0;
+    }
+
+    r->src[r->count] = ids[0];
+    r->dst[r->count] = rd > 1 ? ids[1] : ids[0];
+    r->single[r->count] = rd == 1;
+    if (r->weight)
+      r->weight[r->count] = rd == 3 ? weight : 1.0;
+    r->count++;
+  }
+
+  r->lines = reader.line;
+  r->error = rd < 0;
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// builds the graph from the parsed ranges (in file order)
+static graph_t *load_merge (char *name, load_range_t *ranges, int threads, int is_directed)
+{
+  graph_t *g = create_graph(name);
+  size_t total = 0, n = 0;
+  int weighted = 0;
+
+  for (int t = 0; t < threads; ++t)
+  {
+    total += ranges[t].count;
+    weighted |= ranges[t].weight != NULL;
+  }
+
+  int *src = (int *) malloc((total + 1) * sizeof(int));
+  int *dst = (int *) malloc((total + 1) * sizeof(int));
+  int error = !g || !src || !dst;
+
+  // creates the vertices in order of appearance and gathers the edges
+  for (int t = 0; t < threads && !error; ++t)
+    for (size_t i = 0; i < ranges[t].count && !error; ++i)
+    {
+      load_range_t *r = &ranges[t];
+
+      if (!find_or_add_vertex(g, r->src[i], r->src[i]) ||
+          (!r->single[i] && !find_or_add_vertex(g, r->dst[i], r->dst[i])))
+        error = 1;
+
+      if (!r->single[i])
+      {
+        src[n] = r->src[i];
+        dst[n++] = r->dst[i];
+      }
+    }
+
+  if (!error && graph_add_edges(g, src, dst, n, is_directed ? 0 : BATCH_UNDIRECTED) < 0)
+    error = 1;
+
+  // the first line of each pair gives its weight, so the lines are walked
+  // backwards and the earlier ones overwrite the later ones
+  if (!error && weighted)
+  {
+    g->flags |= GRAPH_WEIGHTED;
+
+    for (int t = threads - 1; t >= 0; --t)
+      for (size_t i = ranges[t].count; i-- > 0;)
+      {
+        load_range_t *r = &ranges[t];
+        double weight = r->weight ? r->weight[i] : 1.0;
+        vertex_t *v1, *v2;
+        edge_t *e;
+
+        if (r->single[i])
+          continue;
+
+        v1 = get_vertex_by_id(g, r->src[i]);
+        v2 = get_vertex_by_id(g, r->dst[i]);
+
+        if ((e = get_edge(v1, v2)))
+          e->weight = weight;
+        if (!is_directed && (e = get_edge(v2, v1)))
+          e->weight = weight;
+      }
+  }
+
+  free(src);
+  free(dst);
+
+  if (error)
+  {
+    destroy_graph(g);
+    return NULL;
+  }
+
+  return g;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+graph_t *read_graph_parallel (char *name, const char *path, int is_directed, int threads)
+{
+  if (!name || !path)
+    return NULL;
+
+  if (threads < 1)
+    threads = 1;
+
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  const char *data;
+  size_t size;
+
+  if (fd < 0)
+    return NULL;
+
+  if (fstat(fd, &st) < 0)
+  {
+    close(fd);
+    return NULL;
+  }
+
+  if (!(size = st.st_size)) // nothing to map
+  {
+    close(fd);
+    return create_graph(name);
+  }
+
+  data = (const char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file open
+
+  if (data == MAP_FAILED)
+    return NULL;
+
+  load_range_t *ranges = (load_range_t *) calloc(threads, sizeof(load_range_t));
+  graph_t *g = NULL;
+
+  if (ranges)
+  {
+    size_t line = 0;
+    int failed = -1;
+
+    // every range ends right after a newline (or at the end of the file)
+    for (int t = 0; t < threads; ++t)
+    {
+      const char *end = data + size * (t + 1) / threads, *newline;
+
+      ranges[t].begin = t ? ranges[t - 1].end : data;
+      if (end < ranges[t].begin)
+        end = ranges[t].begin;
+      if (end > data && end < data + size && end[-1] != '\n')
+        end = (newline = (const char *) memchr(end, '\n', data + size - end)) ? newline + 1 : data + size;
+      ranges[t].end = t == threads - 1 ? data + size : end;
+    }
+
+    // the calling thread parses the first range, a range whose thread cannot
+    // be created is parsed here too
+    for (int t = 1; t < threads; ++t)
+      ranges[t].started = !pthread_create(&(ranges[t].thread), NULL, load_worker, &ranges[t]);
+
+    load_worker(&ranges[0]);
+
+    for (int t = 1; t < threads; ++t)
+      if (ranges[t].started)
+        pthread_join(ranges[t].thread, NULL);
+      else
+        load_worker(&ranges[t]);
+
+    for (int t = 0; t < threads && failed < 0; ++t)
+      if (ranges[t].error)
+        failed = t;
+      else
+        line += ranges[t].lines;
+
+    if (failed >= 0) // badly formatted input
+      fprintf(stderr, "Error: Unable to read input (line %zu)\n", line + ranges[failed].lines);
+    else
+      g = load_merge(name, ranges, threads, is_directed);
+  }
+
+  for (int t = 0; ranges && t < threads; ++t)
+  {
+    free(ranges[t].src);
+    free(ranges[t].dst);
+    free(ranges[t].single);
+    free(ranges[t].weight);
+  }
+
+  free(ranges);
+  munmap((void *) data, size);
+
+  return g;
+}
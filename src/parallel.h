@@ -0,0 +1,94 @@
+#ifndef __PARALLEL__
+#define __PARALLEL__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "csr.h"
+
+/* ------------------------------------------------------------------------------
+ * function: parallel_bfs
+ * ------------------------------------------------------------------------------
+ * multi-threaded breadth first search over a csr. Each level is either
+ * expanded top-down (the frontier vertices push to their neighbours) or
+ * bottom-up (every unvisited vertex looks for a parent in the frontier),
+ * whichever needs to check fewer edges. The visited set is an atomic bitmap
+ * and every thread collects what it finds in its own buffer.
+ *
+ * out: csr of the graph
+ * in: transposed csr (see csr_transpose), used by the bottom-up steps. It can
+ * be NULL if the graph is undirected, then out is used.
+ * source: index of the first vertex
+ * depth: receives the distance from the source of every index, or -1 if the
+ * vertex is not reachable (room for out->size entries)
+ * threads: number of threads (values smaller than 1 mean 1)
+ *
+ * returns: number of reached vertices or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+int parallel_bfs (csr_t *out, csr_t *in, int source, int *depth, int threads) ;
+
+/* ------------------------------------------------------------------------------
+ * function: pagerank
+ * ------------------------------------------------------------------------------
+ * multi-threaded PageRank over a csr. Every iteration pulls the scores of the
+ * in-neighbours of each vertex from a contiguous array (one sparse matrix
+ * vector product over the transposed csr), so no edges list is walked. The
+ * rank of the vertices without out-edges is spread like a teleport.
+ *
+ * out: csr of the graph
+ * in: transposed csr (see csr_transpose), or NULL to build it here. If the
+ * graph is undirected, out can be given again.
+ * rank: receives the score of every index, adding up to 1 (room for
+ * out->size entries)
+ * damping: probability of following an edge instead of teleporting (0.85 is
+ * the usual value)
+ * tolerance: the iterations stop when the scores change less than this (sum
+ * of the absolute changes)
+ * max_iterations: upper limit of iterations
+ * threads: number of threads (values smaller than 1 mean 1)
+ *
+ * returns: number of iterations done or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+int pagerank (csr_t *out, csr_t *in, double *rank, double damping, double tolerance, int max_iterations, int threads) ;
+
+/* ------------------------------------------------------------------------------
+ * function: personalized_pagerank
+ * ------------------------------------------------------------------------------
+ * same as pagerank, but the teleports land on each index in proportion to
+ * its weight in personalization instead of uniformly
+ *
+ * personalization: non negative weight of every index (out->size entries, at
+ * least one of them positive), or NULL for the uniform pagerank
+ *
+ * returns: number of iterations done or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+int personalized_pagerank (csr_t *out, csr_t *in, const double *personalization, double *rank,
+                           double damping, double tolerance, int max_iterations, int threads) ;
+
+/* ------------------------------------------------------------------------------
+ * function: read_graph_parallel
+ * ------------------------------------------------------------------------------
+ * reads a graph file in the read_graph format with many threads. The file is
+ * mapped and split in byte ranges that end at a newline, and every thread
+ * parses its range into its own buffer. The vertices are then created in the
+ * order they first appear in the file (like in read_graph, single id lines
+ * included) and the edges are inserted at once with graph_add_edges, which
+ * drops the repeated ones. The edges lists end up sorted by the dense index
+ * of the destination instead of the file order.
+ *
+ * name: name of the graph
+ * path: path of the file to be read
+ * is_directed: indicates if the graph is directed (1) or not (0)
+ * threads: number of threads
+ *
+ * returns: pointer to the read graph or NULL if the file cannot be read or is
+ * badly formatted
+ * ------------------------------------------------------------------------------ */
+
+graph_t *read_graph_parallel (char *name, const char *path, int is_directed, int threads) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,141 @@
+#include "pool.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define POOL_MAX_SLAB_ITEMS (1 << 16)
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct slab_t slab_t ;
+
+// header of every slab, the items follow it
+struct slab_t
+{
+  slab_t *next ;
+  void *align ;
+} ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int pool_grow (pool_t *p)
+{
+  slab_t *slab = (slab_t *) malloc(sizeof(slab_t) + p->slab_items * p->item_size);
+
+  if (!slab)
+    return 0;
+
+  slab->next = (slab_t *) p->slabs;
+  p->slabs = slab;
+  p->cursor = (char *) (slab + 1);
+  p->limit = p->cursor + p->slab_items * p->item_size;
+
+  if (p->slab_items < POOL_MAX_SLAB_ITEMS) // fewer slabs for large graphs
+    p->slab_items *= 2;
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void pool_init (pool_t *p, size_t item_size, size_t slab_items)
+{
+  if (!p)
+    return;
+
+  if (item_size < sizeof(void *)) // the free list is stored inside the items
+    item_size = sizeof(void *);
+
+  p->item_size = (item_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+  p->slab_items = slab_items;
+  p->slabs = p->free_list = NULL;
+  p->cursor = p->limit = NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void *pool_alloc (pool_t *p)
+{
+  if (!p)
+    return NULL;
+
+  if (!p->slab_items)
+    return malloc(p->item_size);
+
+  void *item;
+
+  if ((item = p->free_list)) // reuses a freed item
+  {
+    p->free_list = *(void **) item;
+    return item;
+  }
+
+  if (p->cursor == p->limit && !pool_grow(p))
+    return NULL;
+
+  item = p->cursor;
+  p->cursor += p->item_size;
+  return item;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void *pool_alloc_block (pool_t *p, size_t n)
+{
+  if (!p || !p->slab_items || !n)
+    return NULL;
+
+  slab_t *slab = (slab_t *) malloc(sizeof(slab_t) + n * p->item_size);
+
+  if (!slab)
+    return NULL;
+
+  // goes after the current slab, so its unused items are not lost
+  if (p->slabs)
+  {
+    slab->next = ((slab_t *) p->slabs)->next;
+    ((slab_t *) p->slabs)->next = slab;
+  }
+  else
+  {
+    slab->next = NULL;
+    p->slabs = slab;
+  }
+
+  return slab + 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void pool_free (pool_t *p, void *item)
+{
+  if (!p || !item)
+    return;
+
+  if (!p->slab_items)
+  {
+    free(item);
+    return;
+  }
+
+  *(void **) item = p->free_list;
+  p->free_list = item;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void pool_destroy (pool_t *p)
+{
+  if (!p)
+    return;
+
+  slab_t *slab;
+
+  while ((slab = (slab_t *) p->slabs))
+  {
+    p->slabs = slab->next;
+    free(slab);
+  }
+
+  p->free_list = NULL;
+  p->cursor = p->limit = NULL;
+}
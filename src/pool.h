@@ -0,0 +1,101 @@
+#ifndef __POOL__
+#define __POOL__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stddef.h>
+#include <stdlib.h>
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct pool_t pool_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: pool
+ * ------------------------------------------------------------------------------
+ * slab allocator for fixed size items. Items are carved from large slabs and
+ * freed items are kept in a free list to be reused by the next allocation.
+ * All the memory is given back at once when the pool is destroyed.
+ *
+ * slabs: list of allocated slabs
+ * free_list: list of freed items
+ * cursor: next unused item of the current slab
+ * limit: end of the current slab
+ * item_size: size of each item (rounded up to the pointer alignment)
+ * slab_items: number of items in the next slab (0 means plain malloc/free)
+ * ------------------------------------------------------------------------------ */
+
+struct pool_t
+{
+  void *slabs ;
+  void *free_list ;
+  char *cursor, *limit ;
+  size_t item_size ;
+  size_t slab_items ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: pool_init
+ * ------------------------------------------------------------------------------
+ * initializes an empty pool (no memory is allocated until the first item)
+ *
+ * p: pool to be initialized
+ * item_size: size of the items that will be allocated
+ * slab_items: number of items of the first slab, the next slabs grow
+ * geometrically. If it is 0 the pool forwards every call to malloc/free.
+ * ------------------------------------------------------------------------------ */
+
+void pool_init (pool_t *p, size_t item_size, size_t slab_items) ;
+
+/* ------------------------------------------------------------------------------
+ * function: pool_alloc
+ * ------------------------------------------------------------------------------
+ * allocates an item from the pool
+ *
+ * p: pool from which the item will be allocated
+ *
+ * returns: pointer to the item or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+void *pool_alloc (pool_t *p) ;
+
+/* ------------------------------------------------------------------------------
+ * function: pool_alloc_block
+ * ------------------------------------------------------------------------------
+ * allocates n contiguous items in a slab of their own. Each item can later be
+ * given back with pool_free like any other item.
+ *
+ * p: pool from which the items will be allocated (must not be a malloc/free
+ * pool)
+ * n: number of items
+ *
+ * returns: pointer to the first item or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+void *pool_alloc_block (pool_t *p, size_t n) ;
+
+/* ------------------------------------------------------------------------------
+ * function: pool_free
+ * ------------------------------------------------------------------------------
+ * gives an item back to the pool, so it can be reused
+ *
+ * p: pool that allocated the item
+ * item: item to be freed
+ * ------------------------------------------------------------------------------ */
+
+void pool_free (pool_t *p, void *item) ;
+
+/* ------------------------------------------------------------------------------
+ * function: pool_destroy
+ * ------------------------------------------------------------------------------
+ * deallocate all the slabs of the pool, which frees every item allocated from
+ * it in O(number of slabs). Items from a malloc/free pool are not touched.
+ *
+ * p: pool to have the memory deallocated
+ * ------------------------------------------------------------------------------ */
+
+void pool_destroy (pool_t *p) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
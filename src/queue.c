@@ -2,7 +2,18 @@
 
 /* ------------------------------------------------------------------------------ */
 
-void queue_append (queue_t **queue, queue_t *elem)
+void queue_init (queue_head_t *queue)
+{
+  if (!queue)
+    return ;
+
+  queue->first = NULL;
+  queue->size = 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void queue_append (queue_head_t *queue, queue_t *elem)
 {
   if (!queue || !elem)
   {
@@ -10,57 +21,97 @@ void queue_append (queue_t **queue, queue_t *elem)
     return ;
   }
 
-  if (*queue) // if the queue is not empty
+  if (queue->first) // if the queue is not empty
   {
-    queue_t *last = (*queue)->prev;
-    elem->next = (*queue);
-    (*queue)->prev = elem;
+    queue_t *last = queue->first->prev;
+    elem->next = queue->first;
+    queue->first->prev = elem;
     elem->prev = last;
     last->next = elem;
   }
   else
   {
-    (*queue) = elem;
-    (*queue)->next = (*queue)->prev = elem;
+    queue->first = elem;
+    elem->next = elem->prev = elem;
   }
 
+  queue->size++;
   return ;
 }
 
 /* ------------------------------------------------------------------------------ */
 
-queue_t *queue_remove (queue_t **queue, queue_t *elem)
+void queue_prepend (queue_head_t *queue, queue_t *elem)
 {
   if (!queue || !elem)
+  {
+    fprintf(stderr, "Error: queue_prepend\n");
+    return ;
+  }
+
+  // in a circular queue the new last element is also the new first one
+  queue_append(queue, elem);
+  queue->first = elem;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+queue_t *queue_remove (queue_head_t *queue, queue_t *elem)
+{
+  if (!queue || !elem || !queue->size)
   {
     fprintf(stderr, "Error: queue_remove\n");
     return NULL;
   }
 
-  queue_t *aux = elem;
-
-  if (aux == (*queue)) // if it is the beginning of the queue
-    (*queue) = aux->next == aux ? NULL : (*queue)->next; // if it is the only element in the queue
+  if (elem == queue->first) // if it is the beginning of the queue
+    queue->first = elem->next == elem ? NULL : elem->next; // if it is the only element in the queue
 
   elem->prev->next = elem->next;
   elem->next->prev = elem->prev;
   elem->next = elem->prev = NULL;
+  queue->size--;
   return elem;
 }
 
 /* ------------------------------------------------------------------------------ */
 
-unsigned int queue_size (queue_t *queue)
+queue_t *queue_pop (queue_head_t *queue)
 {
-  unsigned int size = 0;
+  if (!queue)
+  {
+    fprintf(stderr, "Error: queue_pop\n");
+    return NULL;
+  }
+
+  return queue->first ? queue_remove(queue, queue->first) : NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void queue_splice (queue_head_t *queue, queue_head_t *other)
+{
+  if (!queue || !other)
+  {
+    fprintf(stderr, "Error: queue_splice\n");
+    return ;
+  }
 
-  if (queue)
+  if (!other->first) // nothing to move
+    return ;
+
+  if (queue->first) // links the last element of queue to the first of other
   {
-    queue_t *it = queue;
-    do
-      size++;
-    while ((it = it->next) != queue);
+    queue_t *last = queue->first->prev, *other_last = other->first->prev;
+
+    last->next = other->first;
+    other->first->prev = last;
+    other_last->next = queue->first;
+    queue->first->prev = other_last;
   }
+  else
+    queue->first = other->first;
 
-  return size;
+  queue->size += other->size;
+  queue_init(other);
 }
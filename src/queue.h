@@ -8,6 +8,7 @@
 /* ------------------------------------------------------------------------------ */
 
 typedef struct queue_t queue_t ;
+typedef struct queue_head_t queue_head_t ;
 
 /* ------------------------------------------------------------------------------
  * structure: generic queue
@@ -20,6 +21,33 @@ struct queue_t
   queue_t *prev, *next ;
 } ;
 
+/* ------------------------------------------------------------------------------
+ * structure: queue head
+ * ------------------------------------------------------------------------------
+ * handle of a circular queue that keeps its size, so it takes O(1) to know
+ * it. The elements are intrusive: any structure that starts with the prev and
+ * next pointers (like vertex_t and edge_t) is used through a cast to queue_t.
+ *
+ * first: first element of the queue (NULL if it is empty)
+ * size: number of elements in the queue
+ * ------------------------------------------------------------------------------ */
+
+struct queue_head_t
+{
+  queue_t *first ;
+  unsigned int size ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: queue_init
+ * ------------------------------------------------------------------------------
+ * initializes an empty queue
+ *
+ * queue: queue to be initialized
+ * ------------------------------------------------------------------------------ */
+
+void queue_init (queue_head_t *queue) ;
+
 /* ------------------------------------------------------------------------------
  * function: queue_append
  * ------------------------------------------------------------------------------
@@ -29,7 +57,18 @@ struct queue_t
  * elem: element to be inserted in the queue
  * ------------------------------------------------------------------------------ */
 
-void queue_append (queue_t **queue, queue_t *elem) ;
+void queue_append (queue_head_t *queue, queue_t *elem) ;
+
+/* ------------------------------------------------------------------------------
+ * function: queue_prepend
+ * ------------------------------------------------------------------------------
+ * inserts an element at the beginning of the queue
+ *
+ * queue: queue in which the element will be inserted
+ * elem: element to be inserted in the queue
+ * ------------------------------------------------------------------------------ */
+
+void queue_prepend (queue_head_t *queue, queue_t *elem) ;
 
 /* ------------------------------------------------------------------------------
  * function: queue_remove
@@ -37,24 +76,50 @@ void queue_append (queue_t **queue, queue_t *elem) ;
  * removes the element from the queue, without destroying it
  *
  * queue: queue from which the element will be removed
- * elem: element to be removed of the queue
+ * elem: element of the queue to be removed
  *
  * returns: pointer to the removed element or NULL if an error has ocurred
  * ------------------------------------------------------------------------------ */
 
-queue_t *queue_remove (queue_t **queue, queue_t *elem) ;
+queue_t *queue_remove (queue_head_t *queue, queue_t *elem) ;
+
+/* ------------------------------------------------------------------------------
+ * function: queue_pop
+ * ------------------------------------------------------------------------------
+ * removes the first element of the queue, without destroying it
+ *
+ * queue: queue from which the element will be removed
+ *
+ * returns: pointer to the removed element or NULL if the queue is empty
+ * ------------------------------------------------------------------------------ */
+
+queue_t *queue_pop (queue_head_t *queue) ;
+
+/* ------------------------------------------------------------------------------
+ * function: queue_splice
+ * ------------------------------------------------------------------------------
+ * moves every element of a queue to the end of another one in O(1)
+ *
+ * queue: queue that will receive the elements
+ * other: queue whose elements will be moved (it ends up empty)
+ * ------------------------------------------------------------------------------ */
+
+void queue_splice (queue_head_t *queue, queue_head_t *other) ;
 
 /* ------------------------------------------------------------------------------
  * function: queue_size
  * ------------------------------------------------------------------------------
- * counts the number of elements in the queue
+ * gives the number of elements in the queue in O(1)
  *
- * queue: queue in which the elements will be counted
+ * queue: queue to be queried
  *
  * returns: the number of elements in the queue
  * ------------------------------------------------------------------------------ */
 
-unsigned int queue_size (queue_t *queue) ;
+static inline unsigned int queue_size (const queue_head_t *queue)
+{
+  return queue ? queue->size : 0;
+}
 
 /* ------------------------------------------------------------------------------ */
 
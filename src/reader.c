@@ -0,0 +1,206 @@
+#include <string.h>
+
+#include "reader.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define READER_MAX_IDS 2
+#define READER_MAX_WEIGHT 64
+
+/* ------------------------------------------------------------------------------ */
+
+static inline int is_blank (char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// makes sure a whole line is available, returns its end (the newline or the
+// end of the data) or NULL if the line does not fit in the buffer
+static const char *reader_fill (reader_t *r)
+{
+  const char *newline = (const char *) memchr(r->pos, '\n', r->end - r->pos);
+
+  while (!newline && r->input && !feof(r->input))
+  {
+    size_t left = r->end - r->pos, read;
+
+    if (left == READER_BUFFER_SIZE) // line too long
+      return NULL;
+
+    // keeps the incomplete line at the beginning of the buffer
+    memmove(r->buffer, r->pos, left);
+    read = fread(r->buffer + left, 1, READER_BUFFER_SIZE - left, r->input);
+    r->pos = r->buffer;
+    r->end = r->buffer + left + read;
+
+    if (ferror(r->input))
+      return NULL;
+
+    newline = (const char *) memchr(r->buffer + left, '\n', read);
+  }
+
+  return newline ? newline : r->end;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int reader_init (reader_t *r, FILE *input)
+{
+  if (!r || !input)
+    return 0;
+
+  if (!(r->buffer = (char *) malloc(READER_BUFFER_SIZE)))
+    return 0;
+
+  r->input = input;
+  r->pos = r->end = r->buffer;
+  r->line = 0;
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void reader_init_memory (reader_t *r, const char *data, size_t size)
+{
+  if (!r)
+    return;
+
+  r->input = NULL;
+  r->buffer = NULL;
+  r->pos = data;
+  r->end = data + size;
+  r->line = 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// parses a weight (strtod format) that ends at a blank or at eol
+static const char *parse_weight (const char *p, const char *eol, double *weight)
+{
+  char text[READER_MAX_WEIGHT], *end;
+  size_t n = 0;
+
+  // copies the token, the data is not null terminated
+  while (p + n < eol && !is_blank(p[n]))
+    if (++n == READER_MAX_WEIGHT)
+      return NULL;
+
+  memcpy(text, p, n);
+  text[n] = '\0';
+  *weight = strtod(text, &end);
+
+  if (end != text + n || *weight != *weight) // not a number
+    return NULL;
+
+  return p + n;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// parses the next non blank line, the weight is only accepted if it is not NULL
+static int parse_line (reader_t *r, int *ids, double *weight)
+{
+  const char *p, *eol;
+  int count;
+
+  do
+  {
+    if (r->pos == r->end && (!r->input || feof(r->input)))
+      return 0;
+
+    if (!(eol = reader_fill(r)))
+    {
+      r->line++;
+      return -1;
+    }
+
+    if (r->pos == eol && eol == r->end) // nothing left after the refill
+      return 0;
+
+    r->line++;
+    count = 0;
+
+    for (p = r->pos; p < eol;)
+    {
+      if (is_blank(*p))
+      {
+        p++;
+        continue;
+      }
+
+      if (count == READER_MAX_IDS)
+      {
+        if (!weight || !(p = parse_weight(p, eol, weight)))
+          return -1;
+
+        count++;
+        continue;
+      }
+
+      if (count > READER_MAX_IDS) // nothing after the weight
+        return -1;
+
+      // integer: optional sign and up to 10 digits (enough for every int)
+      int negative = (*p == '-');
+      const char *digits;
+      long long value = 0;
+
+      if (*p == '-' || *p == '+')
+        p++;
+
+      for (digits = p; p < eol && (unsigned char) (*p - '0') < 10 && p - digits < 10; ++p)
+        value = value * 10 + (*p - '0');
+
+      if (p == digits || (p < eol && !is_blank(*p)))
+        return -1;
+
+      if (negative)
+        value = -value;
+
+      if (value > 2147483647LL || value < -2147483648LL)
+        return -1;
+
+      ids[count++] = (int) value;
+    }
+
+    // skips the newline
+    r->pos = eol < r->end ? eol + 1 : eol;
+  }
+  while (!count); // blank line
+
+  return count;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int reader_line (reader_t *r, int *ids)
+{
+  if (!r || !ids)
+    return -1;
+
+  return parse_line(r, ids, NULL);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int reader_edge (reader_t *r, int *ids, double *weight)
+{
+  if (!r || !ids || !weight)
+    return -1;
+
+  return parse_line(r, ids, weight);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void reader_close (reader_t *r)
+{
+  if (!r)
+    return;
+
+  free(r->buffer);
+  r->buffer = NULL;
+}
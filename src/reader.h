@@ -0,0 +1,107 @@
+#ifndef __READER__
+#define __READER__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* ------------------------------------------------------------------------------ */
+
+#define READER_BUFFER_SIZE (1 << 20)
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct reader_t reader_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: reader
+ * ------------------------------------------------------------------------------
+ * parser of the read_graph format (one or two integers by line, optionally
+ * followed by a weight). It reads the input in large chunks, or parses a
+ * memory range directly.
+ *
+ * input: input from which the data will be read (NULL for memory ranges)
+ * buffer: chunk buffer (READER_BUFFER_SIZE bytes, only used with an input)
+ * pos: next byte to be parsed
+ * end: end of the data available
+ * line: number of the last line read (starts at 1)
+ * ------------------------------------------------------------------------------ */
+
+struct reader_t
+{
+  FILE *input ;
+  char *buffer ;
+  const char *pos, *end ;
+  size_t line ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: reader_init
+ * ------------------------------------------------------------------------------
+ * initializes a reader over an input
+ *
+ * r: reader to be initialized
+ * input: input from which the data will be read
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int reader_init (reader_t *r, FILE *input) ;
+
+/* ------------------------------------------------------------------------------
+ * function: reader_init_memory
+ * ------------------------------------------------------------------------------
+ * initializes a reader over a memory range (nothing is copied)
+ *
+ * r: reader to be initialized
+ * data: first byte of the range
+ * size: size of the range
+ * ------------------------------------------------------------------------------ */
+
+void reader_init_memory (reader_t *r, const char *data, size_t size) ;
+
+/* ------------------------------------------------------------------------------
+ * function: reader_line
+ * ------------------------------------------------------------------------------
+ * parses the next non blank line. A line must have one or two integers
+ * separated by blanks (spaces, tabs or a carriage return).
+ *
+ * r: reader from which the line will be read
+ * ids: receives the integers of the line (room for 2)
+ *
+ * returns: number of integers read, 0 at the end of the input or -1 if the
+ * line is badly formatted (r->line tells which one)
+ * ------------------------------------------------------------------------------ */
+
+int reader_line (reader_t *r, int *ids) ;
+
+/* ------------------------------------------------------------------------------
+ * function: reader_edge
+ * ------------------------------------------------------------------------------
+ * parses the next non blank line like reader_line, but a line with two
+ * integers can also have a weight (a decimal number) after them
+ *
+ * r: reader from which the line will be read
+ * ids: receives the integers of the line (room for 2)
+ * weight: receives the weight of the line (left untouched if there is none)
+ *
+ * returns: number of values read (3 if the line has a weight), 0 at the end
+ * of the input or -1 if the line is badly formatted (r->line tells which one)
+ * ------------------------------------------------------------------------------ */
+
+int reader_edge (reader_t *r, int *ids, double *weight) ;
+
+/* ------------------------------------------------------------------------------
+ * function: reader_close
+ * ------------------------------------------------------------------------------
+ * deallocate the memory used by the reader (the input is not closed)
+ *
+ * r: reader to be closed
+ * ------------------------------------------------------------------------------ */
+
+void reader_close (reader_t *r) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,182 @@
+#include "reorder.h"
+
+/* ------------------------------------------------------------------------------ */
+
+static int compare_keys (const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+  return (x > y) - (x < y);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// dense indices by increasing (or decreasing) degree, counting sort so the
+// ties keep the index order
+static int degree_order (graph_t *g, int *order, int descending)
+{
+  int max = max_degree(g);
+  int *first = (int *) calloc(max + 2, sizeof(int));
+
+  if (!first)
+    return 0;
+
+  for (int i = 0; i < g->size; ++i)
+    first[(descending ? max - g->table[i]->degree : g->table[i]->degree) + 1]++;
+  for (int d = 1; d <= max; ++d)
+    first[d] += first[d - 1];
+  for (int i = 0; i < g->size; ++i)
+    order[first[descending ? max - g->table[i]->degree : g->table[i]->degree]++] = i;
+
+  free(first);
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// breadth first order of every component. With rcm the components start at
+// their lowest degree vertex, the neighbours are taken by increasing degree
+// and the whole order is reversed at the end.
+static int breadth_first_order (graph_t *g, int *order, int rcm)
+{
+  unsigned char *visited = (unsigned char *) calloc(g->size / 8 + 1, sizeof(unsigned char));
+  int *starts = rcm ? (int *) malloc(g->size * sizeof(int)) : NULL;
+  uint64_t *keys = rcm ? (uint64_t *) malloc((max_degree(g) + 1) * sizeof(uint64_t)) : NULL;
+  int head = 0, tail = 0;
+  edge_t *edge_it;
+
+  if (!visited || (rcm && (!starts || !keys || !degree_order(g, starts, 0))))
+  {
+    free(visited);
+    free(starts);
+    free(keys);
+    return 0;
+  }
+
+  for (int k = 0; k < g->size; ++k)
+  {
+    int start = starts ? starts[k] : k;
+
+    if (visited[start >> 3] & (1 << (start & 7)))
+      continue;
+
+    visited[start >> 3] |= 1 << (start & 7);
+    order[tail++] = start;
+
+    // the order array is also the queue, every vertex enters it once
+    while (head < tail)
+    {
+      vertex_t *v = g->table[order[head++]];
+      int first = tail;
+
+      if ((edge_it = v->edges))
+        do
+        {
+          int index = edge_it->vertex->index;
+
+          if (!(visited[index >> 3] & (1 << (index & 7))))
+          {
+            visited[index >> 3] |= 1 << (index & 7);
+            order[tail++] = index;
+          }
+        }
+        while ((edge_it = edge_it->next) != v->edges);
+
+      if (rcm && tail - first > 1) // the new neighbours by increasing degree
+      {
+        for (int i = first; i < tail; ++i)
+          keys[i - first] = (uint64_t) g->table[order[i]]->degree << 32 | (uint32_t) order[i];
+
+        qsort(keys, tail - first, sizeof(uint64_t), compare_keys);
+
+        for (int i = first; i < tail; ++i)
+          order[i] = (int) (uint32_t) keys[i - first];
+      }
+    }
+  }
+
+  for (int i = 0; rcm && i < g->size / 2; ++i)
+  {
+    int aux = order[i];
+
+    order[i] = order[g->size - 1 - i];
+    order[g->size - 1 - i] = aux;
+  }
+
+  free(visited);
+  free(starts);
+  free(keys);
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int graph_order (graph_t *g, int method, int *order)
+{
+  if (!g || !order)
+    return 0;
+
+  if (!g->size)
+    return method >= REORDER_RCM && method <= REORDER_BFS;
+
+  switch (method)
+  {
+    case REORDER_RCM:
+      return breadth_first_order(g, order, 1);
+
+    case REORDER_DEGREE:
+      return degree_order(g, order, 1);
+
+    case REORDER_BFS:
+      return breadth_first_order(g, order, 0);
+  }
+
+  return 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int relabel_graph (graph_t *g, const int *order)
+{
+  if (!g || !order)
+    return 0;
+
+  vertex_t **table = (vertex_t **) malloc((g->size + 1) * sizeof(vertex_t *));
+  int ok = table != NULL;
+
+  for (int i = 0; ok && i < g->size; ++i)
+    table[i] = NULL;
+
+  // every old index must appear once
+  for (int i = 0; ok && i < g->size; ++i)
+    if (order[i] < 0 || order[i] >= g->size || table[order[i]])
+      ok = 0;
+    else
+      table[order[i]] = g->table[order[i]];
+
+  for (int i = 0; ok && i < g->size; ++i)
+  {
+    table[i] = g->table[order[i]];
+    table[i]->index = i;
+  }
+
+  if (ok && g->size)
+    memcpy(g->table, table, g->size * sizeof(vertex_t *));
+
+  free(table);
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int reorder_graph (graph_t *g, int method)
+{
+  if (!g)
+    return 0;
+
+  int *order = (int *) malloc((g->size + 1) * sizeof(int));
+  int ok = order && graph_order(g, method, order) && relabel_graph(g, order);
+
+  free(order);
+  return ok;
+}
@@ -0,0 +1,72 @@
+#ifndef __REORDER__
+#define __REORDER__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "graph.h"
+
+/* ------------------------------------------------------------------------------
+ * reordering methods
+ * ------------------------------------------------------------------------------
+ * REORDER_RCM: reverse Cuthill-McKee, a breadth first order from a low degree
+ * vertex of each component that visits the neighbours by increasing degree,
+ * reversed at the end. It keeps the neighbours of a vertex close to it
+ * (small bandwidth), good for meshes and road like graphs.
+ * REORDER_DEGREE: by decreasing degree (ties keep the old order), so the hubs
+ * share the first cache lines
+ * REORDER_BFS: breadth first order from the first vertex of each component
+ * ------------------------------------------------------------------------------ */
+
+#define REORDER_RCM 0
+#define REORDER_DEGREE 1
+#define REORDER_BFS 2
+
+/* ------------------------------------------------------------------------------
+ * function: graph_order
+ * ------------------------------------------------------------------------------
+ * computes a new order of the vertices, following the edges lists (in
+ * directed graphs only the out-edges)
+ *
+ * g: graph to be ordered
+ * method: REORDER_RCM, REORDER_DEGREE or REORDER_BFS
+ * order: receives the current dense index of the vertex that goes to each
+ * position (room for g->size entries)
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int graph_order (graph_t *g, int method, int *order) ;
+
+/* ------------------------------------------------------------------------------
+ * function: relabel_graph
+ * ------------------------------------------------------------------------------
+ * gives new dense indices to the vertices: the vertex g->table[order[i]] gets
+ * the index i. The ids, values and edges do not change, but every array
+ * indexed by v->index built afterwards (csr snapshots, traversal bitmaps)
+ * follows the new order. The vertices list (print_graph and write_graph
+ * order) is kept. Not thread safe.
+ *
+ * g: graph to be relabeled
+ * order: permutation of 0 .. g->size - 1 (see graph_order)
+ *
+ * returns: 0 if order is not a permutation or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int relabel_graph (graph_t *g, const int *order) ;
+
+/* ------------------------------------------------------------------------------
+ * function: reorder_graph
+ * ------------------------------------------------------------------------------
+ * computes an order with graph_order and applies it with relabel_graph
+ *
+ * g: graph to be reordered
+ * method: REORDER_RCM, REORDER_DEGREE or REORDER_BFS
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int reorder_graph (graph_t *g, int method) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,343 @@
+#include "snapshot.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define SNAPSHOT_LEVELS (32 / SNAPSHOT_BITS)
+
+/* ------------------------------------------------------------------------------ */
+
+// mixes the id (a bijection, so two ids never get the same key)
+static inline uint32_t key_of (int id)
+{
+  return (uint32_t) id * 2654435761u;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// slot of a key in a branch of a given level, the high bits (the best mixed)
+// come first
+static inline int digit (uint32_t key, int level)
+{
+  return (key >> (32 - SNAPSHOT_BITS * (level + 1))) & (SNAPSHOT_FANOUT - 1);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static snapshot_branch_t *create_branch (void)
+{
+  snapshot_branch_t *b = (snapshot_branch_t *) calloc(1, sizeof(snapshot_branch_t));
+
+  if (b)
+    b->node.refs = 1;
+
+  return b;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// makes the node in a slot exclusive to the version that holds the slot (the
+// slot itself must already be), copying it if a snapshot shares it
+static snapshot_node_t *own (snapshot_node_t **slot)
+{
+  snapshot_node_t *node = *slot;
+
+  // only the version can add references, so 1 stays 1 until it shares it
+  if (__atomic_load_n(&(node->refs), __ATOMIC_ACQUIRE) == 1)
+    return node;
+
+  if (node->leaf)
+  {
+    snapshot_vertex_t *v = (snapshot_vertex_t *) node;
+    snapshot_vertex_t *copy = (snapshot_vertex_t *) malloc(sizeof(snapshot_vertex_t));
+
+    if (!copy)
+      return NULL;
+
+    // room for the neighbour that is usually added right after the copy
+    copy->capacity = v->degree + 1;
+    if (!(copy->neighbours = (int *) malloc(copy->capacity * sizeof(int))))
+    {
+      free(copy);
+      return NULL;
+    }
+
+    copy->node.leaf = 1;
+    copy->id = v->id;
+    copy->value = v->value;
+    copy->degree = v->degree;
+    if (v->degree)
+      memcpy(copy->neighbours, v->neighbours, v->degree * sizeof(int));
+
+    *slot = &(copy->node);
+  }
+  else
+  {
+    snapshot_branch_t *b = (snapshot_branch_t *) node;
+    snapshot_branch_t *copy = (snapshot_branch_t *) malloc(sizeof(snapshot_branch_t));
+
+    if (!copy)
+      return NULL;
+
+    copy->node.leaf = 0;
+    for (int k = 0; k < SNAPSHOT_FANOUT; ++k)
+      version_retain(copy->child[k] = b->child[k]);
+
+    *slot = &(copy->node);
+  }
+
+  (*slot)->refs = 1;
+  version_release(node);
+  return *slot;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// finds the slot of an id without changing anything
+static snapshot_node_t *const *find_slot (snapshot_node_t *const *slot, int id)
+{
+  uint32_t key = key_of(id);
+
+  for (int level = 0; *slot && !(*slot)->leaf; ++level)
+    slot = &(((snapshot_branch_t *) *slot)->child[digit(key, level)]);
+
+  return (*slot && ((snapshot_vertex_t *) *slot)->id == id) ? slot : NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// finds the slot of an id that is in the version, copying the branches on the
+// way (the slot itself is not copied)
+static snapshot_node_t **own_slot (snapshot_node_t **root, int id)
+{
+  uint32_t key = key_of(id);
+  snapshot_node_t **slot = root;
+
+  for (int level = 0; !(*slot)->leaf; ++level)
+  {
+    snapshot_node_t *b = own(slot);
+
+    if (!b)
+      return NULL;
+
+    slot = &(((snapshot_branch_t *) b)->child[digit(key, level)]);
+  }
+
+  return slot;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// visits the vertices below a node until visit asks to stop
+static void visit_node (const snapshot_node_t *node, int (*visit) (const snapshot_vertex_t *v, void *arg), void *arg,
+                        int *count, int *stop)
+{
+  if (node->leaf)
+  {
+    (*count)++;
+    *stop = visit((const snapshot_vertex_t *) node, arg) != 0;
+    return;
+  }
+
+  const snapshot_branch_t *b = (const snapshot_branch_t *) node;
+
+  for (int k = 0; k < SNAPSHOT_FANOUT && !*stop; ++k)
+    if (b->child[k])
+      visit_node(b->child[k], visit, arg, count, stop);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+const snapshot_vertex_t *snapshot_find (const snapshot_t *s, int id)
+{
+  if (!s)
+    return NULL;
+
+  snapshot_node_t *const *slot = find_slot(&(s->root), id);
+
+  return slot ? (const snapshot_vertex_t *) *slot : NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int snapshot_foreach (const snapshot_t *s, int (*visit) (const snapshot_vertex_t *v, void *arg), void *arg)
+{
+  int count = 0, stop = 0;
+
+  if (s && s->root && visit)
+    visit_node(s->root, visit, arg, &count, &stop);
+
+  return count;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void snapshot_release (snapshot_t *s)
+{
+  if (!s)
+    return;
+
+  version_release(s->root);
+  free(s);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+snapshot_node_t *version_create (void)
+{
+  snapshot_branch_t *b = create_branch();
+
+  return b ? &(b->node) : NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int version_insert (snapshot_node_t **root, int id, int value)
+{
+  if (!root || !*root)
+    return 0;
+
+  if (find_slot(root, id))
+    return 1;
+
+  snapshot_vertex_t *v = (snapshot_vertex_t *) malloc(sizeof(snapshot_vertex_t));
+  uint32_t key = key_of(id);
+  snapshot_node_t **slot = root;
+
+  if (!v)
+    return 0;
+
+  v->node.refs = 1;
+  v->node.leaf = 1;
+  v->id = id;
+  v->value = value;
+  v->degree = v->capacity = 0;
+  v->neighbours = NULL;
+
+  for (int level = 0; level < SNAPSHOT_LEVELS; ++level)
+  {
+    snapshot_branch_t *b = (snapshot_branch_t *) own(slot);
+
+    if (!b)
+      break;
+
+    slot = &(b->child[digit(key, level)]);
+
+    if (!*slot)
+    {
+      *slot = &(v->node);
+      return 1;
+    }
+
+    if ((*slot)->leaf) // the other vertex goes one level down
+    {
+      snapshot_branch_t *split = create_branch();
+
+      if (!split)
+        break;
+
+      split->child[digit(key_of(((snapshot_vertex_t *) *slot)->id), level + 1)] = *slot;
+      *slot = &(split->node);
+    }
+  }
+
+  free(v);
+  return 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int version_remove (snapshot_node_t **root, int id)
+{
+  if (!root || !*root)
+    return 0;
+
+  if (!find_slot(root, id))
+    return 1;
+
+  // the empty branches are kept, they are reused by the next inserts
+  snapshot_node_t **slot = own_slot(root, id);
+
+  if (!slot)
+    return 0;
+
+  version_release(*slot);
+  *slot = NULL;
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+snapshot_vertex_t *version_vertex (snapshot_node_t **root, int id)
+{
+  if (!root || !*root || !find_slot(root, id))
+    return NULL;
+
+  snapshot_node_t **slot = own_slot(root, id);
+
+  return slot ? (snapshot_vertex_t *) own(slot) : NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int version_link (snapshot_vertex_t *v, int id)
+{
+  if (!v)
+    return 0;
+
+  if (v->degree == v->capacity)
+  {
+    int capacity = v->capacity ? 2 * v->capacity : 4;
+    int *neighbours = (int *) realloc(v->neighbours, capacity * sizeof(int));
+
+    if (!neighbours)
+      return 0;
+
+    v->neighbours = neighbours;
+    v->capacity = capacity;
+  }
+
+  v->neighbours[v->degree++] = id;
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int version_unlink (snapshot_vertex_t *v, int id)
+{
+  if (!v)
+    return 0;
+
+  // the order is not kept, the last neighbour fills the hole
+  for (int i = 0; i < v->degree; ++i)
+    if (v->neighbours[i] == id)
+    {
+      v->neighbours[i] = v->neighbours[--v->degree];
+      return 1;
+    }
+
+  return 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void version_retain (snapshot_node_t *node)
+{
+  if (node)
+    __atomic_add_fetch(&(node->refs), 1, __ATOMIC_RELAXED);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void version_release (snapshot_node_t *node)
+{
+  if (!node || __atomic_sub_fetch(&(node->refs), 1, __ATOMIC_ACQ_REL))
+    return;
+
+  if (node->leaf)
+    free(((snapshot_vertex_t *) node)->neighbours);
+  else
+    for (int k = 0; k < SNAPSHOT_FANOUT; ++k)
+      version_release(((snapshot_branch_t *) node)->child[k]);
+
+  free(node);
+}
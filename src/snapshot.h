@@ -0,0 +1,252 @@
+#ifndef __SNAPSHOT__
+#define __SNAPSHOT__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------------------ */
+
+#define SNAPSHOT_BITS 4
+#define SNAPSHOT_FANOUT (1 << SNAPSHOT_BITS)
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct snapshot_t snapshot_t ;
+typedef struct snapshot_node_t snapshot_node_t ;
+typedef struct snapshot_branch_t snapshot_branch_t ;
+typedef struct snapshot_vertex_t snapshot_vertex_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: snapshot node
+ * ------------------------------------------------------------------------------
+ * header of the nodes of a version: a persistent trie indexed by the mixed
+ * vertex id, SNAPSHOT_BITS bits per level, with the vertices in the leaves.
+ * The nodes are shared by every version that did not change them and are
+ * freed when the last one is released. A node is only changed in place while
+ * a single version holds it; otherwise it is copied first (copy-on-write), so
+ * a snapshot never changes.
+ *
+ * refs: number of parents (or snapshots) pointing to the node
+ * leaf: indicates if the node is a vertex (1) or a branch (0)
+ * ------------------------------------------------------------------------------ */
+
+struct snapshot_node_t
+{
+  unsigned int refs ;
+  int leaf ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: snapshot branch
+ * ------------------------------------------------------------------------------
+ * node: node header
+ * child: branches or vertices below this one (NULL if empty)
+ * ------------------------------------------------------------------------------ */
+
+struct snapshot_branch_t
+{
+  snapshot_node_t node ;
+  snapshot_node_t *child[SNAPSHOT_FANOUT] ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: snapshot vertex
+ * ------------------------------------------------------------------------------
+ * a vertex as it was when the snapshot was taken (edge weights are not kept)
+ *
+ * node: node header
+ * id: vertex id
+ * value: vertex value
+ * degree: number of neighbours
+ * capacity: number of slots in neighbours
+ * neighbours: ids of the neighbours, in no particular order (the order of the
+ * edges list until an edge is removed)
+ * ------------------------------------------------------------------------------ */
+
+struct snapshot_vertex_t
+{
+  snapshot_node_t node ;
+  int id ;
+  int value ;
+  int degree ;
+  int capacity ;
+  int *neighbours ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * structure: snapshot
+ * ------------------------------------------------------------------------------
+ * read only view of a graph at some point in time (see graph_snapshot). It
+ * can be read by any number of threads without locks while the graph keeps
+ * changing.
+ *
+ * The version is a single trie shared by every stripe, so while the graph
+ * keeps one each change updates it under the graph lock. With
+ * GRAPH_CONCURRENT the writers of different stripes then wait for each other
+ * during that update (the copy of a vertex and the branches above it), even
+ * if no snapshot is held.
+ *
+ * root: root of the version
+ * size: number of vertices
+ * edges: number of edges (sum of the degrees)
+ * ------------------------------------------------------------------------------ */
+
+struct snapshot_t
+{
+  snapshot_node_t *root ;
+  int size ;
+  long edges ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: snapshot_find
+ * ------------------------------------------------------------------------------
+ * finds a vertex of the snapshot by id
+ *
+ * s: snapshot in which the vertex will be searched
+ * id: id of the vertex
+ *
+ * returns: pointer to the vertex or NULL if it was not in the graph
+ * ------------------------------------------------------------------------------ */
+
+const snapshot_vertex_t *snapshot_find (const snapshot_t *s, int id) ;
+
+/* ------------------------------------------------------------------------------
+ * function: snapshot_foreach
+ * ------------------------------------------------------------------------------
+ * calls a function for every vertex of the snapshot (in no particular order)
+ *
+ * s: snapshot to be visited
+ * visit: function called for each vertex, returns 0 to continue or any other
+ * value to stop
+ * arg: user argument given to visit
+ *
+ * returns: number of visited vertices
+ * ------------------------------------------------------------------------------ */
+
+int snapshot_foreach (const snapshot_t *s, int (*visit) (const snapshot_vertex_t *v, void *arg), void *arg) ;
+
+/* ------------------------------------------------------------------------------
+ * function: snapshot_release
+ * ------------------------------------------------------------------------------
+ * gives a snapshot back, freeing the nodes that no other version uses. It
+ * can be called from any thread, at any time.
+ *
+ * s: snapshot to be released
+ * ------------------------------------------------------------------------------ */
+
+void snapshot_release (snapshot_t *s) ;
+
+/* ------------------------------------------------------------------------------
+ * versions, used by graph.c to keep the current version of a graph. They
+ * must not run at the same time on the same version.
+ * ------------------------------------------------------------------------------ */
+
+/* ------------------------------------------------------------------------------
+ * function: version_create
+ * ------------------------------------------------------------------------------
+ * creates an empty version
+ *
+ * returns: root of the version or NULL if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+snapshot_node_t *version_create (void) ;
+
+/* ------------------------------------------------------------------------------
+ * function: version_insert
+ * ------------------------------------------------------------------------------
+ * adds a vertex without neighbours to a version (nothing is done if the id is
+ * already there)
+ *
+ * root: root of the version, changed if copied
+ * id: vertex id
+ * value: vertex value
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int version_insert (snapshot_node_t **root, int id, int value) ;
+
+/* ------------------------------------------------------------------------------
+ * function: version_remove
+ * ------------------------------------------------------------------------------
+ * removes a vertex from a version
+ *
+ * root: root of the version, changed if copied
+ * id: vertex id
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int version_remove (snapshot_node_t **root, int id) ;
+
+/* ------------------------------------------------------------------------------
+ * function: version_vertex
+ * ------------------------------------------------------------------------------
+ * finds a vertex of a version to be changed, copying it and its path when a
+ * snapshot still uses them
+ *
+ * root: root of the version, changed if copied
+ * id: vertex id
+ *
+ * returns: pointer to the vertex, only held by this version, or NULL if it
+ * does not exist or an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+snapshot_vertex_t *version_vertex (snapshot_node_t **root, int id) ;
+
+/* ------------------------------------------------------------------------------
+ * function: version_link
+ * ------------------------------------------------------------------------------
+ * appends a neighbour to a vertex returned by version_vertex
+ *
+ * v: vertex that receives the neighbour
+ * id: id of the neighbour
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int version_link (snapshot_vertex_t *v, int id) ;
+
+/* ------------------------------------------------------------------------------
+ * function: version_unlink
+ * ------------------------------------------------------------------------------
+ * removes the first occurrence of a neighbour from a vertex returned by
+ * version_vertex in O(degree). The last neighbour takes its place, so the
+ * neighbours do not keep their order.
+ *
+ * v: vertex that loses the neighbour
+ * id: id of the neighbour
+ *
+ * returns: 1 if the neighbour was found or 0 if not
+ * ------------------------------------------------------------------------------ */
+
+int version_unlink (snapshot_vertex_t *v, int id) ;
+
+/* ------------------------------------------------------------------------------
+ * function: version_retain
+ * ------------------------------------------------------------------------------
+ * adds a reference to a node (a new snapshot of the version)
+ *
+ * node: node to be retained (can be NULL)
+ * ------------------------------------------------------------------------------ */
+
+void version_retain (snapshot_node_t *node) ;
+
+/* ------------------------------------------------------------------------------
+ * function: version_release
+ * ------------------------------------------------------------------------------
+ * drops a reference to a node, freeing it (and releasing its children) when
+ * it was the last one
+ *
+ * node: node to be released (can be NULL)
+ * ------------------------------------------------------------------------------ */
+
+void version_release (snapshot_node_t *node) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
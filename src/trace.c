@@ -0,0 +1,117 @@
+#include "trace.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#ifdef GRAPH_TRACE
+
+static const char *counter_names[TRACE_COUNTERS] =
+{
+  "vertices allocated",
+  "edges allocated",
+  "hash probes",
+  "search_edge hops",
+  "lines parsed",
+  "bytes written"
+};
+
+static const char *function_names[TRACE_FUNCTIONS] =
+{
+  "create_graph",
+  "add_vertex",
+  "find_or_add_vertex",
+  "remove_vertex",
+  "add_edge",
+  "graph_add_edges",
+  "remove_edge",
+  "get_vertex_by_id",
+  "search_neighbourhood",
+  "get_edge",
+  "read_graph",
+  "write_graph",
+  "destroy_graph",
+  "release_vertex",
+  "release_edge",
+  "search_edge",
+  "print_graph",
+  "edge_count",
+  "max_degree",
+  "min_degree",
+  "degree_histogram",
+  "search_vertex_in_array",
+  "graph_snapshot"
+};
+
+uint64_t trace_counters[TRACE_COUNTERS];
+
+static uint64_t trace_calls[TRACE_FUNCTIONS];
+static uint64_t trace_ns[TRACE_FUNCTIONS];
+static trace_hook_t trace_hook;
+
+/* ------------------------------------------------------------------------------ */
+
+void trace_record (trace_function_t function, uint64_t start)
+{
+  uint64_t ns = trace_now() - start;
+  trace_hook_t hook = __atomic_load_n(&trace_hook, __ATOMIC_ACQUIRE);
+
+  __atomic_fetch_add(&(trace_calls[function]), 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&(trace_ns[function]), ns, __ATOMIC_RELAXED);
+
+  if (hook)
+    hook(function_names[function], ns);
+}
+
+#endif
+
+/* ------------------------------------------------------------------------------ */
+
+void graph_set_trace_hook (trace_hook_t hook)
+{
+#ifdef GRAPH_TRACE
+  __atomic_store_n(&trace_hook, hook, __ATOMIC_RELEASE);
+#else
+  (void) hook;
+#endif
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void graph_stats_reset (void)
+{
+#ifdef GRAPH_TRACE
+  for (int i = 0; i < TRACE_COUNTERS; ++i)
+    __atomic_store_n(&(trace_counters[i]), 0, __ATOMIC_RELAXED);
+
+  for (int i = 0; i < TRACE_FUNCTIONS; ++i)
+  {
+    __atomic_store_n(&(trace_calls[i]), 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&(trace_ns[i]), 0, __ATOMIC_RELAXED);
+  }
+#endif
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void graph_stats_dump (FILE *output)
+{
+  if (!output)
+    return;
+
+#ifdef GRAPH_TRACE
+  for (int i = 0; i < TRACE_COUNTERS; ++i)
+    fprintf(output, "%-22s %14lu\n", counter_names[i],
+            (unsigned long) __atomic_load_n(&(trace_counters[i]), __ATOMIC_RELAXED));
+
+  for (int i = 0; i < TRACE_FUNCTIONS; ++i)
+  {
+    uint64_t calls = __atomic_load_n(&(trace_calls[i]), __ATOMIC_RELAXED);
+    uint64_t ns = __atomic_load_n(&(trace_ns[i]), __ATOMIC_RELAXED);
+
+    if (calls) // only the functions that were used
+      fprintf(output, "%-22s %14lu calls %12.3f ms %10.1f ns/call\n", function_names[i],
+              (unsigned long) calls, ns / 1e6, (double) ns / calls);
+  }
+#else
+  fprintf(output, "graph stats: tracing is off (build with make TRACE=1)\n");
+#endif
+}
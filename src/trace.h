@@ -0,0 +1,148 @@
+#ifndef __TRACE__
+#define __TRACE__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/* ------------------------------------------------------------------------------
+ * instrumentation of the graph hot paths, compiled in only with GRAPH_TRACE
+ * (make TRACE=1). Without it the macros below expand to nothing, so the
+ * library pays nothing for them; the functions still exist, graph_stats_dump
+ * just says that tracing is off.
+ *
+ * TRACE_COUNT(counter, n): adds n to a counter (relaxed atomic, so it is
+ * safe with GRAPH_CONCURRENT)
+ * TRACE_BEGIN(): starts timing the current function call
+ * TRACE_END(function): records the call, its time and calls the trace hook
+ * ------------------------------------------------------------------------------ */
+
+typedef enum trace_counter_t trace_counter_t ;
+typedef enum trace_function_t trace_function_t ;
+typedef void (*trace_hook_t) (const char *function, uint64_t ns) ;
+
+/* ------------------------------------------------------------------------------
+ * enumeration: trace counter
+ * ------------------------------------------------------------------------------
+ * TRACE_VERTICES: vertices allocated
+ * TRACE_EDGES: edges allocated (in-edges included)
+ * TRACE_PROBES: hash slots probed by the vertex index and the edge set
+ * (get_vertex_by_id, search_neighbourhood, get_edge, ...)
+ * TRACE_HOPS: list hops in search_edge
+ * TRACE_LINES: lines parsed by read_graph
+ * TRACE_BYTES: bytes written by the writers (write_graph, csr_write_binary)
+ * ------------------------------------------------------------------------------ */
+
+enum trace_counter_t
+{
+  TRACE_VERTICES,
+  TRACE_EDGES,
+  TRACE_PROBES,
+  TRACE_HOPS,
+  TRACE_LINES,
+  TRACE_BYTES,
+  TRACE_COUNTERS
+} ;
+
+/* ------------------------------------------------------------------------------
+ * enumeration: trace function
+ * ------------------------------------------------------------------------------
+ * public graph functions that are timed (every function of graph.h except
+ * create_graph_flags and add_weighted_edge, which are timed as create_graph
+ * and add_edge). The internal calls made under the stripe locks are not
+ * timed, so the hook never runs while a lock is held.
+ * ------------------------------------------------------------------------------ */
+
+enum trace_function_t
+{
+  TRACE_CREATE_GRAPH,
+  TRACE_ADD_VERTEX,
+  TRACE_FIND_OR_ADD_VERTEX,
+  TRACE_REMOVE_VERTEX,
+  TRACE_ADD_EDGE,
+  TRACE_ADD_EDGES,
+  TRACE_REMOVE_EDGE,
+  TRACE_GET_VERTEX_BY_ID,
+  TRACE_SEARCH_NEIGHBOURHOOD,
+  TRACE_GET_EDGE,
+  TRACE_READ_GRAPH,
+  TRACE_WRITE_GRAPH,
+  TRACE_DESTROY_GRAPH,
+  TRACE_RELEASE_VERTEX,
+  TRACE_RELEASE_EDGE,
+  TRACE_SEARCH_EDGE,
+  TRACE_PRINT_GRAPH,
+  TRACE_EDGE_COUNT,
+  TRACE_MAX_DEGREE,
+  TRACE_MIN_DEGREE,
+  TRACE_DEGREE_HISTOGRAM,
+  TRACE_SEARCH_VERTEX_IN_ARRAY,
+  TRACE_GRAPH_SNAPSHOT,
+  TRACE_FUNCTIONS
+} ;
+
+/* ------------------------------------------------------------------------------ */
+
+#ifdef GRAPH_TRACE
+
+extern uint64_t trace_counters[TRACE_COUNTERS] ;
+
+static inline uint64_t trace_now (void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+void trace_record (trace_function_t function, uint64_t start) ;
+
+#define TRACE_COUNT(counter, n) \
+  __atomic_fetch_add(&(trace_counters[counter]), (uint64_t) (n), __ATOMIC_RELAXED)
+#define TRACE_BEGIN() uint64_t trace_start = trace_now()
+#define TRACE_END(function) trace_record(function, trace_start)
+
+#else
+
+#define TRACE_COUNT(counter, n) ((void) 0)
+#define TRACE_BEGIN() ((void) 0)
+#define TRACE_END(function) ((void) 0)
+
+#endif
+
+/* ------------------------------------------------------------------------------
+ * function: graph_set_trace_hook
+ * ------------------------------------------------------------------------------
+ * sets a function called at the end of every timed call (see
+ * trace_function_t) with the function name and its time in nanoseconds. It
+ * is called by the thread that made the call. Ignored without GRAPH_TRACE.
+ *
+ * hook: function to be called, or NULL to remove it
+ * ------------------------------------------------------------------------------ */
+
+void graph_set_trace_hook (trace_hook_t hook) ;
+
+/* ------------------------------------------------------------------------------
+ * function: graph_stats_reset
+ * ------------------------------------------------------------------------------
+ * sets every counter and timing to zero
+ * ------------------------------------------------------------------------------ */
+
+void graph_stats_reset (void) ;
+
+/* ------------------------------------------------------------------------------
+ * function: graph_stats_dump
+ * ------------------------------------------------------------------------------
+ * prints the counters and, for each timed function, the number of calls and
+ * the total and mean time
+ *
+ * output: file in which the stats will be printed
+ * ------------------------------------------------------------------------------ */
+
+void graph_stats_dump (FILE *output) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,285 @@
+#include <math.h>
+
+#include "traversal.h"
+
+/* ------------------------------------------------------------------------------ */
+
+// visited bitmap indexed by v->index
+#define IS_VISITED(bitmap, v) ((bitmap)[(v)->index >> 3] & (1 << ((v)->index & 7)))
+#define SET_VISITED(bitmap, v) ((bitmap)[(v)->index >> 3] |= 1 << ((v)->index & 7))
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct dfs_frame_t
+{
+  vertex_t *vertex ;
+  edge_t *edge ;
+} dfs_frame_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+// breadth first search that stops at target (if it is not NULL), parent gets
+// the vertex that reached each index (if it is not NULL)
+static int bfs (graph_t *g, vertex_t *source, vertex_t *target, vertex_t **parent, visit_fn visit, void *arg)
+{
+  if (!g || !source || source->graph != g)
+    return -1;
+
+  vertex_t **frontier = (vertex_t **) malloc(g->size * sizeof(vertex_t *));
+  unsigned char *visited = (unsigned char *) calloc(g->size / 8 + 1, sizeof(unsigned char));
+  int head = 0, tail = 0, depth = 0, level_end;
+  edge_t *edge_it;
+
+  if (!frontier || !visited)
+  {
+    free(frontier);
+    free(visited);
+    return -1;
+  }
+
+  // every vertex enters the frontier once, so it never wraps around
+  frontier[tail++] = source;
+  SET_VISITED(visited, source);
+  if (parent)
+    parent[source->index] = NULL;
+  level_end = tail;
+
+  while (head < tail)
+  {
+    vertex_t *v = frontier[head++];
+
+    if ((visit && visit(v, depth, arg)) || v == target)
+      break;
+
+    if ((edge_it = v->edges))
+      do
+        if (!IS_VISITED(visited, edge_it->vertex))
+        {
+          SET_VISITED(visited, edge_it->vertex);
+          if (parent)
+            parent[edge_it->vertex->index] = v;
+          frontier[tail++] = edge_it->vertex;
+        }
+      while ((edge_it = edge_it->next) != v->edges);
+
+    if (head == level_end) // next level
+    {
+      depth++;
+      level_end = tail;
+    }
+  }
+
+  free(frontier);
+  free(visited);
+  return head;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int breadth_first_search (graph_t *g, vertex_t *source, visit_fn visit, void *arg)
+{
+  return bfs(g, source, NULL, NULL, visit, arg);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int depth_first_search (graph_t *g, vertex_t *source, visit_fn visit, void *arg)
+{
+  if (!g || !source || source->graph != g)
+    return -1;
+
+  dfs_frame_t *stack = (dfs_frame_t *) malloc(g->size * sizeof(dfs_frame_t));
+  unsigned char *visited = (unsigned char *) calloc(g->size / 8 + 1, sizeof(unsigned char));
+  int top = 0, count = 1;
+
+  if (!stack || !visited)
+  {
+    free(stack);
+    free(visited);
+    return -1;
+  }
+
+  SET_VISITED(visited, source);
+  stack[top].vertex = source;
+  stack[top].edge = source->edges;
+
+  if (visit && visit(source, 0, arg))
+    top = -1;
+
+  while (top >= 0)
+  {
+    dfs_frame_t *frame = &stack[top];
+    vertex_t *next = NULL;
+
+    // finds the next unvisited neighbour of the vertex on top
+    while (frame->edge && !next)
+    {
+      if (!IS_VISITED(visited, frame->edge->vertex))
+        next = frame->edge->vertex;
+
+      frame->edge = frame->edge->next;
+      if (frame->edge == frame->vertex->edges) // back to the first edge
+        frame->edge = NULL;
+    }
+
+    if (!next) // all the neighbours were visited
+    {
+      top--;
+      continue;
+    }
+
+    SET_VISITED(visited, next);
+    count++;
+    stack[++top].vertex = next;
+    stack[top].edge = next->edges;
+
+    if (visit && visit(next, top, arg))
+      break;
+  }
+
+  free(stack);
+  free(visited);
+  return count;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int find_root (int *parent, int i)
+{
+  while (parent[i] != i) // path halving
+    i = parent[i] = parent[parent[i]];
+
+  return i;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int connected_components (graph_t *g, int *component)
+{
+  if (!g || !component)
+    return -1;
+
+  int *parent = (int *) malloc((g->size + 1) * sizeof(int));
+  int count = 0;
+  edge_t *edge_it;
+
+  if (!parent)
+    return -1;
+
+  for (int i = 0; i < g->size; ++i)
+    parent[i] = i;
+
+  // union find over every edge, so the direction of the edges does not matter
+  for (int i = 0; i < g->size; ++i)
+    if ((edge_it = g->table[i]->edges))
+      do
+      {
+        int r1 = find_root(parent, i), r2 = find_root(parent, edge_it->vertex->index);
+
+        if (r1 != r2) // the smallest index is the root
+          parent[r1 > r2 ? r1 : r2] = r1 > r2 ? r2 : r1;
+      }
+      while ((edge_it = edge_it->next) != g->table[i]->edges);
+
+  // roots come before the rest of their component
+  for (int i = 0; i < g->size; ++i)
+    component[i] = parent[i] == i ? count++ : component[find_root(parent, i)];
+
+  free(parent);
+  return count;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int shortest_path (graph_t *g, vertex_t *source, vertex_t *target, vertex_t **path)
+{
+  if (!g || !source || !target || target->graph != g)
+    return -1;
+
+  vertex_t **parent = (vertex_t **) malloc(g->size * sizeof(vertex_t *));
+  vertex_t *v;
+  int length = 0;
+
+  if (!parent)
+    return -1;
+
+  // target gets a parent only if it is reached
+  parent[target->index] = target;
+
+  if (bfs(g, source, target, parent, NULL, NULL) < 0 || (target != source && parent[target->index] == target))
+  {
+    free(parent);
+    return -1;
+  }
+
+  for (v = target; v != source; v = parent[v->index])
+    length++;
+
+  if (path) // walks back from the target
+  {
+    v = target;
+    for (int i = length; i >= 0; --i, v = parent[v->index])
+      path[i] = v;
+  }
+
+  free(parent);
+  return length;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int dijkstra (graph_t *g, vertex_t *source, double *dist, vertex_t **parent)
+{
+  if (!g || !source || source->graph != g || !dist)
+    return -1;
+
+  heap_t h;
+  edge_t *edge_it;
+  double d;
+  int index, reached = 0;
+
+  if (!heap_init(&h, g->size, HEAP_ARITY))
+    return -1;
+
+  for (int i = 0; i < g->size; ++i)
+  {
+    dist[i] = INFINITY;
+    if (parent)
+      parent[i] = NULL;
+  }
+
+  dist[source->index] = 0.0;
+  heap_update(&h, source->index, 0.0);
+
+  // every vertex leaves the heap once, with its final distance
+  while ((index = heap_pop(&h, &d)) >= 0)
+  {
+    vertex_t *v = g->table[index];
+
+    reached++;
+
+    if ((edge_it = v->edges))
+      do
+      {
+        int next = edge_it->vertex->index;
+
+        if (edge_it->weight < 0)
+        {
+          heap_destroy(&h);
+          return -1;
+        }
+
+        if (d + edge_it->weight < dist[next])
+        {
+          dist[next] = d + edge_it->weight;
+          heap_update(&h, next, dist[next]);
+          if (parent)
+            parent[next] = v;
+        }
+      }
+      while ((edge_it = edge_it->next) != v->edges);
+  }
+
+  heap_destroy(&h);
+  return reached;
+}
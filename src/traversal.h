@@ -0,0 +1,113 @@
+#ifndef __TRAVERSAL__
+#define __TRAVERSAL__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "graph.h"
+#include "heap.h"
+
+/* ------------------------------------------------------------------------------
+ * type: visit function
+ * ------------------------------------------------------------------------------
+ * called for every vertex reached by a traversal
+ *
+ * v: vertex reached
+ * depth: distance from the source (bfs) or depth in the search tree (dfs)
+ * arg: user argument given to the traversal
+ *
+ * returns: 0 to continue the traversal or any other value to stop it
+ * ------------------------------------------------------------------------------ */
+
+typedef int (*visit_fn) (vertex_t *v, int depth, void *arg) ;
+
+/* ------------------------------------------------------------------------------
+ * function: breadth_first_search
+ * ------------------------------------------------------------------------------
+ * visits the vertices reachable from the source in breadth first order,
+ * following the edges lists (in directed graphs only the out-edges). The
+ * frontier is a single array and the visited set is a bitmap indexed by
+ * v->index, so nothing is allocated per vertex.
+ *
+ * g: graph to be traversed
+ * source: first vertex to be visited
+ * visit: function called for every vertex reached (can be NULL)
+ * arg: user argument given to visit
+ *
+ * returns: number of visited vertices or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+int breadth_first_search (graph_t *g, vertex_t *source, visit_fn visit, void *arg) ;
+
+/* ------------------------------------------------------------------------------
+ * function: depth_first_search
+ * ------------------------------------------------------------------------------
+ * visits the vertices reachable from the source in depth first order
+ * (preorder), without recursion
+ *
+ * g: graph to be traversed
+ * source: first vertex to be visited
+ * visit: function called for every vertex reached (can be NULL)
+ * arg: user argument given to visit
+ *
+ * returns: number of visited vertices or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+int depth_first_search (graph_t *g, vertex_t *source, visit_fn visit, void *arg) ;
+
+/* ------------------------------------------------------------------------------
+ * function: connected_components
+ * ------------------------------------------------------------------------------
+ * labels the connected components of the graph (weakly connected components
+ * if the graph is directed). The labels go from 0 to the number of
+ * components - 1, in the order of the dense indices.
+ *
+ * g: graph to be labeled
+ * component: receives the label of each vertex, indexed by v->index (room
+ * for g->size entries)
+ *
+ * returns: number of components or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+int connected_components (graph_t *g, int *component) ;
+
+/* ------------------------------------------------------------------------------
+ * function: shortest_path
+ * ------------------------------------------------------------------------------
+ * finds a path with the fewest edges from source to target (breadth first
+ * search that stops at the target)
+ *
+ * g: graph in which the path will be searched
+ * source: first vertex of the path
+ * target: last vertex of the path
+ * path: receives the vertices of the path from source to target (room for
+ * g->size entries) or NULL if only the length is needed
+ *
+ * returns: number of edges in the path or -1 if target is not reachable
+ * ------------------------------------------------------------------------------ */
+
+int shortest_path (graph_t *g, vertex_t *source, vertex_t *target, vertex_t **path) ;
+
+/* ------------------------------------------------------------------------------
+ * function: dijkstra
+ * ------------------------------------------------------------------------------
+ * finds the shortest weighted paths from the source to every vertex it
+ * reaches (dijkstra's algorithm over a HEAP_ARITY-ary heap with
+ * decrease-key). The weights must not be negative.
+ *
+ * g: graph in which the paths will be searched
+ * source: first vertex of the paths
+ * dist: receives the distance to each vertex, indexed by v->index (room for
+ * g->size entries, INFINITY if the vertex is not reachable)
+ * parent: receives the previous vertex in the path to each vertex, indexed by
+ * v->index (room for g->size entries, NULL for the source and the vertices
+ * that are not reachable) or NULL if only the distances are needed
+ *
+ * returns: number of reached vertices or -1 if an error has ocurred (or a
+ * negative weight was found)
+ * ------------------------------------------------------------------------------ */
+
+int dijkstra (graph_t *g, vertex_t *source, double *dist, vertex_t **parent) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,274 @@
+#include <pthread.h>
+
+#include "triangles.h"
+
+/* ------------------------------------------------------------------------------ */
+
+// vertices taken by a thread at once (the work per vertex is very uneven)
+#define TRIANGLE_CHUNK 64
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct triangle_state_t triangle_state_t ;
+
+// oriented graph shared by the threads, its vertices are numbered by rank
+// (position in the degree order) and each list holds the sorted ranks of the
+// higher neighbours
+struct triangle_state_t
+{
+  size_t *offsets ;
+  int *targets ;
+  long *count ; // triangles through each rank, or NULL
+  size_t cursor ;
+  long total ;
+  int size ;
+  int threads ;
+} ;
+
+/* ------------------------------------------------------------------------------ */
+
+static int compare_ints (const void *a, const void *b)
+{
+  int x = *(const int *) a, y = *(const int *) b;
+
+  return (x > y) - (x < y);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// ranks the vertices by degree (counting sort, ties by index) and builds the
+// oriented lists, returns 0 if out of memory
+static int orient (const csr_t *c, triangle_state_t *s, int *rank)
+{
+  int max = 0;
+
+  for (int i = 0; i < c->size; ++i)
+    if (csr_degree(c, i) > max)
+      max = csr_degree(c, i);
+
+  int *first = (int *) calloc(max + 2, sizeof(int));
+
+  s->offsets = (size_t *) calloc(c->size + 1, sizeof(size_t));
+  if (!first || !s->offsets)
+  {
+    free(first);
+    return 0;
+  }
+
+  for (int i = 0; i < c->size; ++i)
+    first[csr_degree(c, i) + 1]++;
+  for (int d = 1; d <= max; ++d)
+    first[d] += first[d - 1];
+  for (int i = 0; i < c->size; ++i)
+    rank[i] = first[csr_degree(c, i)]++;
+
+  free(first);
+
+  // counts the edges that go up, then fills them in (repeated ones included)
+  for (int i = 0; i < c->size; ++i)
+    for (size_t k = c->offsets[i]; k < c->offsets[i + 1]; ++k)
+      if (rank[c->targets[k]] > rank[i])
+        s->offsets[rank[i] + 1]++;
+
+  for (int r = 0; r < c->size; ++r)
+    s->offsets[r + 1] += s->offsets[r];
+
+  if (!(s->targets = (int *) malloc((s->offsets[c->size] + 1) * sizeof(int))))
+    return 0;
+
+  for (int i = 0; i < c->size; ++i)
+  {
+    size_t at = s->offsets[rank[i]];
+
+    for (size_t k = c->offsets[i]; k < c->offsets[i + 1]; ++k)
+      if (rank[c->targets[k]] > rank[i])
+        s->targets[at++] = rank[c->targets[k]];
+  }
+
+  // sorts each list and drops the repeated edges, packing the lists again
+  size_t used = 0;
+
+  for (int r = 0; r < c->size; ++r)
+  {
+    size_t start = s->offsets[r], end = s->offsets[r + 1];
+
+    qsort(s->targets + start, end - start, sizeof(int), compare_ints);
+    s->offsets[r] = used;
+
+    for (size_t k = start; k < end; ++k)
+      if (k == start || s->targets[k] != s->targets[k - 1])
+        s->targets[used++] = s->targets[k];
+  }
+
+  s->offsets[c->size] = used;
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static inline void add_triangle (triangle_state_t *s, int r)
+{
+  if (s->threads > 1)
+    __atomic_fetch_add(&(s->count[r]), 1, __ATOMIC_RELAXED);
+  else
+    s->count[r]++;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static void *triangle_worker (void *arg)
+{
+  triangle_state_t *s = (triangle_state_t *) arg;
+  const int *targets = s->targets;
+  size_t start;
+  long total = 0;
+
+  while ((start = __atomic_fetch_add(&(s->cursor), TRIANGLE_CHUNK, __ATOMIC_RELAXED)) < (size_t) s->size)
+  {
+    int end = start + TRIANGLE_CHUNK < (size_t) s->size ? (int) start + TRIANGLE_CHUNK : s->size;
+
+    for (int u = (int) start; u < end; ++u)
+      for (size_t i = s->offsets[u]; i < s->offsets[u + 1]; ++i)
+      {
+        int v = targets[i];
+        // the third vertex comes after v in both lists
+        size_t a = i + 1, a_end = s->offsets[u + 1];
+        size_t b = s->offsets[v], b_end = s->offsets[v + 1];
+
+        while (a < a_end && b < b_end)
+          if (targets[a] < targets[b])
+            a++;
+          else if (targets[a] > targets[b])
+            b++;
+          else
+          {
+            total++;
+
+            if (s->count)
+            {
+              add_triangle(s, u);
+              add_triangle(s, v);
+              add_triangle(s, targets[a]);
+            }
+
+            a++;
+            b++;
+          }
+      }
+  }
+
+  __atomic_fetch_add(&(s->total), total, __ATOMIC_RELAXED);
+  return NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// counts the triangles, by index in triangles and the distinct neighbours of
+// each index (self loops excluded) in degree, both optional
+static long triangle_pass (csr_t *c, long *triangles, long *degree, int threads)
+{
+  if (!c)
+    return -1;
+
+  if (threads < 1)
+    threads = 1;
+
+  triangle_state_t s = { NULL, NULL, NULL, 0, 0, c->size, threads };
+  int *rank = (int *) malloc((c->size + 1) * sizeof(int));
+  pthread_t *ids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+  long *by_rank = NULL, total = -1;
+  int started;
+
+  if (triangles)
+    s.count = (long *) calloc(c->size + 1, sizeof(long));
+  if (degree)
+    by_rank = (long *) malloc((c->size + 1) * sizeof(long));
+
+  if (rank && ids && (s.count || !triangles) && (by_rank || !degree) && orient(c, &s, rank))
+  {
+    // the calling thread is the worker 0, the others share the rest
+    for (started = 1; started < threads; ++started)
+      if (pthread_create(&ids[started], NULL, triangle_worker, &s))
+        break;
+
+    triangle_worker(&s);
+
+    for (int i = 1; i < started; ++i)
+      pthread_join(ids[i], NULL);
+
+    total = s.total;
+
+    for (int i = 0; triangles && i < c->size; ++i)
+      triangles[i] = s.count[rank[i]];
+
+    if (degree) // edges going up and down from each rank
+    {
+      for (int r = 0; r < c->size; ++r)
+        by_rank[r] = s.offsets[r + 1] - s.offsets[r];
+
+      for (size_t k = 0; k < s.offsets[c->size]; ++k)
+        by_rank[s.targets[k]]++;
+
+      for (int i = 0; i < c->size; ++i)
+        degree[i] = by_rank[rank[i]];
+    }
+  }
+
+  free(rank);
+  free(ids);
+  free(s.count);
+  free(by_rank);
+  free(s.offsets);
+  free(s.targets);
+
+  return total;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+long count_triangles (csr_t *c, long *triangles, int threads)
+{
+  return triangle_pass(c, triangles, NULL, threads);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int local_clustering (csr_t *c, double *coefficient, int threads)
+{
+  if (!c || !coefficient)
+    return 0;
+
+  long *triangles = (long *) malloc((c->size + 1) * sizeof(long));
+  long *degree = (long *) malloc((c->size + 1) * sizeof(long));
+  int ok = triangles && degree && triangle_pass(c, triangles, degree, threads) >= 0;
+
+  for (int i = 0; ok && i < c->size; ++i)
+    coefficient[i] = degree[i] < 2 ? 0.0 : 2.0 * triangles[i] / ((double) degree[i] * (degree[i] - 1));
+
+  free(triangles);
+  free(degree);
+
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+double global_clustering (csr_t *c, int threads)
+{
+  if (!c)
+    return -1;
+
+  long *degree = (long *) malloc((c->size + 1) * sizeof(long));
+  long total = degree ? triangle_pass(c, NULL, degree, threads) : -1;
+  double paths = 0;
+
+  for (int i = 0; total >= 0 && i < c->size; ++i)
+    paths += (double) degree[i] * (degree[i] - 1) / 2;
+
+  free(degree);
+
+  if (total < 0)
+    return -1;
+
+  return paths > 0 ? 3.0 * total / paths : 0.0;
+}
@@ -0,0 +1,68 @@
+#ifndef __TRIANGLES__
+#define __TRIANGLES__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "csr.h"
+
+/* ------------------------------------------------------------------------------
+ * triangle counting over an undirected csr (every edge stored in both
+ * directions, like freeze_graph of a graph read with is_directed = 0).
+ * Self loops and repeated edges are ignored.
+ *
+ * Every edge is oriented from the lower to the higher degree end (ties broken
+ * by index) and the oriented neighbourhoods are sorted, so each triangle is
+ * found once, by merging the neighbourhoods of the ends of its first edge.
+ * The hubs get short oriented lists, which keeps the work near O(m^1.5) on
+ * skewed graphs. The vertices are shared among the threads in small chunks.
+ * ------------------------------------------------------------------------------ */
+
+/* ------------------------------------------------------------------------------
+ * function: count_triangles
+ * ------------------------------------------------------------------------------
+ * counts the triangles of the graph
+ *
+ * c: undirected csr of the graph
+ * triangles: receives the number of triangles through each index, or NULL
+ * (room for c->size entries)
+ * threads: number of threads (values smaller than 1 mean 1)
+ *
+ * returns: number of triangles or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+long count_triangles (csr_t *c, long *triangles, int threads) ;
+
+/* ------------------------------------------------------------------------------
+ * function: local_clustering
+ * ------------------------------------------------------------------------------
+ * computes the local clustering coefficient of every vertex: the fraction of
+ * pairs of its neighbours that are joined by an edge (0 for vertices with
+ * less than two neighbours)
+ *
+ * c: undirected csr of the graph
+ * coefficient: receives the coefficient of each index (room for c->size
+ * entries)
+ * threads: number of threads (values smaller than 1 mean 1)
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int local_clustering (csr_t *c, double *coefficient, int threads) ;
+
+/* ------------------------------------------------------------------------------
+ * function: global_clustering
+ * ------------------------------------------------------------------------------
+ * computes the global clustering coefficient (transitivity): three times the
+ * number of triangles over the number of paths of length two
+ *
+ * c: undirected csr of the graph
+ * threads: number of threads (values smaller than 1 mean 1)
+ *
+ * returns: coefficient from 0 to 1 or -1 if an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+double global_clustering (csr_t *c, int threads) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,755 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "wal.h"
+
+/* ------------------------------------------------------------------------------ */
+
+#define WAL_MAGIC "QGRAPHW"
+#define WAL_VERSION 1
+#define WAL_BYTE_ORDER 0x01020304
+#define WAL_FRAME 8 // size and checksum before the records of each frame
+
+/* ------------------------------------------------------------------------------ */
+
+// header of the log file
+typedef struct wal_header_t
+{
+  char magic[8] ;
+  uint32_t version ;
+  uint32_t byte_order ;
+} wal_header_t ;
+
+/* ------------------------------------------------------------------------------ */
+
+static void init_header (wal_header_t *h)
+{
+  memset(h, 0, sizeof(wal_header_t));
+  memcpy(h->magic, WAL_MAGIC, sizeof(WAL_MAGIC));
+  h->version = WAL_VERSION;
+  h->byte_order = WAL_BYTE_ORDER;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// fnv-1a, enough to find a frame cut by a crash
+static uint32_t checksum (const unsigned char *data, size_t size)
+{
+  uint32_t h = 2166136261u;
+
+  for (size_t i = 0; i < size; ++i)
+    h = (h ^ data[i]) * 16777619u;
+
+  return h;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// appends a varint, returns the new end
+static inline unsigned char *put_varint (unsigned char *p, uint64_t x)
+{
+  while (x >= 0x80)
+  {
+    *(p++) = (unsigned char) (x | 0x80);
+    x >>= 7;
+  }
+
+  *(p++) = (unsigned char) x;
+  return p;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// appends an int as a zigzag varint (0, -1, 1, -2, ... are 0, 1, 2, 3, ...)
+static inline unsigned char *put_int (unsigned char *p, int x)
+{
+  return put_varint(p, ((uint32_t) x << 1) ^ (uint32_t) (x >> 31));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int get_varint (const unsigned char **p, const unsigned char *end, uint64_t *x)
+{
+  uint64_t value = 0;
+
+  for (int shift = 0; shift < 64 && *p < end; shift += 7)
+  {
+    uint64_t byte = *((*p)++);
+
+    value |= (byte & 0x7f) << shift;
+
+    if (!(byte & 0x80))
+    {
+      *x = value;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int get_int (const unsigned char **p, const unsigned char *end, int *x)
+{
+  uint64_t value;
+
+  if (!get_varint(p, end, &value) || value > UINT32_MAX)
+    return 0;
+
+  *x = (int) ((uint32_t) (value >> 1) ^ -(uint32_t) (value & 1));
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+static int write_all (int fd, const void *data, size_t size)
+{
+  const char *p = (const char *) data;
+
+  while (size)
+  {
+    ssize_t written = write(fd, p, size);
+
+    if (written < 0 && errno == EINTR)
+      continue;
+
+    if (written <= 0)
+      return 0;
+
+    p += written;
+    size -= written;
+  }
+
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// end of the last complete frame of a log, or 0 if the data is not a log
+static size_t valid_end (const unsigned char *data, size_t size)
+{
+  wal_header_t expected;
+  size_t pos = sizeof(wal_header_t);
+  uint32_t frame[2];
+
+  init_header(&expected);
+
+  if (size < sizeof(wal_header_t) || memcmp(data, &expected, sizeof(wal_header_t)))
+    return 0;
+
+  while (size - pos >= WAL_FRAME)
+  {
+    memcpy(frame, data + pos, WAL_FRAME);
+
+    if (frame[0] > size - pos - WAL_FRAME || checksum(data + pos + WAL_FRAME, frame[0]) != frame[1])
+      break;
+
+    pos += WAL_FRAME + frame[0];
+  }
+
+  return pos;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// writes the buffered records as one frame (the lock must be held)
+static void flush_frame (wal_t *w)
+{
+  uint32_t frame[2];
+
+  if (w->used == WAL_FRAME)
+    return;
+
+  frame[0] = (uint32_t) (w->used - WAL_FRAME);
+  frame[1] = checksum(w->buffer + WAL_FRAME, w->used - WAL_FRAME);
+  memcpy(w->buffer, frame, WAL_FRAME);
+
+  if (!write_all(w->fd, w->buffer, w->used))
+    w->error = 1;
+
+  TRACE_COUNT(TRACE_BYTES, w->used);
+  w->bytes += w->used;
+  w->used = WAL_FRAME;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// writes the buffered records and releases the lock before the fsync, so the
+// other threads can keep appending (the lock must be held)
+static void sync_unlock (wal_t *w)
+{
+  int fd = w->fd;
+
+  flush_frame(w);
+  w->pending = 0;
+  pthread_mutex_unlock(&(w->lock));
+
+  if (fsync(fd) < 0)
+  {
+    pthread_mutex_lock(&(w->lock));
+    w->error = 1;
+    pthread_mutex_unlock(&(w->lock));
+  }
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// makes room for a record of up to size bytes, the buffered records are
+// written first if it does not fit (the lock must be held). Returns where the
+// record starts, after its operation byte, or NULL if an error has ocurred.
+static unsigned char *start_record (wal_t *w, int op, size_t size)
+{
+  if (size > UINT32_MAX - WAL_FRAME)
+  {
+    w->error = 1;
+    return NULL;
+  }
+
+  if (w->used + size > w->capacity)
+    flush_frame(w);
+
+  if (WAL_FRAME + size > w->capacity) // a frame of its own
+  {
+    unsigned char *buffer = (unsigned char *) realloc(w->buffer, WAL_FRAME + size);
+
+    if (!buffer)
+    {
+      w->error = 1;
+      return NULL;
+    }
+
+    w->buffer = buffer;
+    w->capacity = WAL_FRAME + size;
+  }
+
+  w->buffer[w->used] = (unsigned char) op;
+  return w->buffer + w->used + 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// ends a record and releases the lock, syncing the log when sync_every
+// records are pending
+static void end_record (wal_t *w, unsigned char *end)
+{
+  w->used = end - w->buffer;
+
+  if (w->sync_every && ++w->pending >= w->sync_every)
+    sync_unlock(w);
+  else
+    pthread_mutex_unlock(&(w->lock));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// applies the records of a frame, returns how many or -1 if one is not valid
+static long apply_frame (graph_t *g, const unsigned char *p, const unsigned char *end)
+{
+  long applied = 0;
+
+  while (p < end)
+  {
+    int op = *(p++), a, b;
+    uint64_t count;
+    double weight = 1.0;
+    vertex_t *v1, *v2;
+    int ok = get_int(&p, end, &a);
+
+    switch (op)
+    {
+      case WAL_ADD_VERTEX:
+        ok = ok && get_int(&p, end, &b) && find_or_add_vertex(g, b, a);
+        break;
+
+      case WAL_ADD_WEIGHTED_EDGE:
+      case WAL_ADD_EDGE:
+      case WAL_REMOVE_EDGE:
+        ok = ok && get_int(&p, end, &b) && (v1 = get_vertex_by_id(g, a)) && (v2 = get_vertex_by_id(g, b));
+
+        if (ok && op == WAL_ADD_WEIGHTED_EDGE)
+        {
+          if ((ok = end - p >= (long) sizeof(double)))
+            memcpy(&weight, p, sizeof(double));
+          p += ok ? sizeof(double) : 0;
+        }
+
+        // a missing edge is left missing, like remove_edge does (the graph
+        // only logs the removals it made, but the replay may start from a
+        // graph that already had changes)
+        if (ok && op == WAL_REMOVE_EDGE)
+          release_edge(g, remove_edge(v1, v2));
+        else if (ok)
+          ok = add_weighted_edge(v1, v2, weight);
+
+        break;
+
+      case WAL_REMOVE_VERTEX:
+        ok = ok && get_int(&p, end, &b) && (v1 = get_vertex_by_id(g, a));
+
+        if (ok)
+          release_vertex(g, remove_vertex(g, v1, b));
+
+        break;
+
+      case WAL_ADD_EDGES:
+        // every id takes at least one byte
+        ok = ok && get_varint(&p, end, &count) && count <= (uint64_t) (end - p) && (v1 = get_vertex_by_id(g, a));
+
+        for (uint64_t i = 0; ok && i < count; ++i)
+        {
+          ok = get_int(&p, end, &b);
+          a = (int) ((uint32_t) a + (uint32_t) b);
+          ok = ok && (v2 = get_vertex_by_id(g, a)) && add_edge(v1, v2);
+        }
+
+        break;
+
+      case WAL_BATCH:
+      {
+        int *src = NULL, *dst = NULL;
+
+        ok = ok && get_varint(&p, end, &count) && count <= (uint64_t) (end - p) / 2;
+
+        if (ok)
+        {
+          src = (int *) malloc((count + 1) * sizeof(int));
+          dst = (int *) malloc((count + 1) * sizeof(int));
+          ok = src && dst;
+        }
+
+        for (uint64_t i = 0; ok && i < count; ++i)
+          ok = get_int(&p, end, &src[i]) && get_int(&p, end, &dst[i]);
+
+        ok = ok && graph_add_edges(g, src, dst, count, a) >= 0;
+        free(src);
+        free(dst);
+        break;
+      }
+
+      default:
+        ok = 0;
+    }
+
+    if (!ok)
+      return -1;
+
+    applied++;
+  }
+
+  return applied;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// writes every vertex, in index order so that a replay gives them the same
+// indices, and then every edges list of the graph to the log, runs of edges of
+// weight 1 in a single record (the lock must be held)
+static void write_graph_records (wal_t *w, graph_t *g)
+{
+  vertex_t *vertex_it;
+  edge_t *edge_it;
+  unsigned char *p;
+
+  for (int i = 0; i < g->size; ++i)
+    if ((p = start_record(w, WAL_ADD_VERTEX, 11)))
+    {
+      p = put_int(p, g->table[i]->id);
+      w->used = put_int(p, g->table[i]->value) - w->buffer;
+    }
+
+  for (int i = 0; i < g->size; ++i)
+  {
+    int run[WAL_RUN], length = 0;
+
+    vertex_it = g->table[i];
+    if ((edge_it = vertex_it->edges))
+      do
+      {
+        int weighted = edge_it->weight != 1.0;
+
+        if (!weighted)
+          run[length++] = edge_it->vertex->id;
+
+        // the run ends when it is full, before a weighted edge or at the end
+        if (length && (length == WAL_RUN || weighted || edge_it->next == vertex_it->edges) &&
+            (p = start_record(w, WAL_ADD_EDGES, 1 + 5 + 5 + 5 * length)))
+        {
+          int last = vertex_it->id;
+
+          p = put_varint(put_int(p, vertex_it->id), length);
+          for (int k = 0; k < length; ++k)
+          {
+            p = put_int(p, (int) ((uint32_t) run[k] - (uint32_t) last));
+            last = run[k];
+          }
+
+          w->used = p - w->buffer;
+          length = 0;
+        }
+
+        if (weighted && (p = start_record(w, WAL_ADD_WEIGHTED_EDGE, 1 + 10 + sizeof(double))))
+        {
+          p = put_int(put_int(p, vertex_it->id), edge_it->vertex->id);
+          memcpy(p, &(edge_it->weight), sizeof(double));
+          w->used = p + sizeof(double) - w->buffer;
+        }
+      }
+      while ((edge_it = edge_it->next) != vertex_it->edges);
+  }
+
+  flush_frame(w);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+// makes a rename in the directory of path durable (best effort, some file
+// systems cannot sync a directory)
+static void sync_directory (const char *path)
+{
+  const char *slash = strrchr(path, '/');
+  char *dir = (char *) calloc(slash ? slash - path + 2 : 2, sizeof(char));
+  int fd;
+
+  if (!dir)
+    return;
+
+  if (slash)
+    memcpy(dir, path, slash == path ? 1 : (size_t) (slash - path));
+  else
+    dir[0] = '.';
+
+  if ((fd = open(dir, O_RDONLY)) >= 0)
+  {
+    fsync(fd);
+    close(fd);
+  }
+
+  free(dir);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+long wal_replay (const char *path, graph_t *g)
+{
+  if (!path || !g)
+    return -1;
+
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  unsigned char *map;
+  long applied = 0, records;
+  size_t end, pos = sizeof(wal_header_t);
+  uint32_t frame[2];
+
+  if (fd < 0)
+    return errno == ENOENT ? 0 : -1;
+
+  if (fstat(fd, &st) < 0)
+  {
+    close(fd);
+    return -1;
+  }
+
+  if (!st.st_size) // created but never written
+  {
+    close(fd);
+    return 0;
+  }
+
+  map = (unsigned char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file open
+
+  if (map == MAP_FAILED)
+    return -1;
+
+  if (!(end = valid_end(map, st.st_size)))
+  {
+    munmap(map, st.st_size);
+    return -1;
+  }
+
+  // the replayed changes are not logged again
+  wal_t *log = g->log;
+
+  g->log = NULL;
+
+  while (pos < end && applied >= 0)
+  {
+    memcpy(frame, map + pos, WAL_FRAME);
+    records = apply_frame(g, map + pos + WAL_FRAME, map + pos + WAL_FRAME + frame[0]);
+    applied = records < 0 ? -1 : applied + records;
+    pos += WAL_FRAME + frame[0];
+  }
+
+  g->log = log;
+  munmap(map, st.st_size);
+  return applied;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+wal_t *wal_open (const char *path, int sync_every)
+{
+  if (!path || sync_every < 0)
+    return NULL;
+
+  int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+  struct stat st;
+  size_t size;
+
+  if (fd < 0)
+    return NULL;
+
+  if (fstat(fd, &st) < 0)
+  {
+    close(fd);
+    return NULL;
+  }
+
+  size = st.st_size;
+
+  if (!size) // a new log starts with the header
+  {
+    wal_header_t h;
+
+    init_header(&h);
+    size = sizeof(wal_header_t);
+
+    if (!write_all(fd, &h, sizeof(wal_header_t)) || fsync(fd) < 0)
+    {
+      close(fd);
+      return NULL;
+    }
+  }
+  else
+  {
+    unsigned char *map = (unsigned char *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    size_t end = map == MAP_FAILED ? 0 : valid_end(map, size);
+
+    if (map != MAP_FAILED)
+      munmap(map, size);
+
+    // cuts off the frame a crash has left incomplete
+    if (!end || (end < size && (ftruncate(fd, end) < 0 || fsync(fd) < 0)))
+    {
+      close(fd);
+      return NULL;
+    }
+
+    size = end;
+  }
+
+  wal_t *w = (wal_t *) calloc(1, sizeof(wal_t));
+
+  if (!w || !(w->path = (char *) calloc(strlen(path) + 1, sizeof(char))) ||
+      !(w->buffer = (unsigned char *) malloc(WAL_BUFFER_SIZE)))
+  {
+    if (w)
+      free(w->path);
+    free(w);
+    close(fd);
+    return NULL;
+  }
+
+  strcpy(w->path, path);
+  pthread_mutex_init(&(w->lock), NULL);
+  w->fd = fd;
+  w->used = WAL_FRAME;
+  w->capacity = WAL_BUFFER_SIZE;
+  w->sync_every = sync_every;
+  w->bytes = w->base = size;
+
+  return w;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void wal_attach (wal_t *w, graph_t *g)
+{
+  if (g)
+    g->log = w;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void wal_append (wal_t *w, int op, int a, int b, double weight)
+{
+  if (!w)
+    return;
+
+  unsigned char *p;
+
+  pthread_mutex_lock(&(w->lock));
+
+  if (!(p = start_record(w, op, 1 + 10 + sizeof(double))))
+  {
+    pthread_mutex_unlock(&(w->lock));
+    return;
+  }
+
+  p = put_int(put_int(p, a), b);
+
+  if (op == WAL_ADD_WEIGHTED_EDGE)
+  {
+    memcpy(p, &weight, sizeof(double));
+    p += sizeof(double);
+  }
+
+  end_record(w, p);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void wal_append_batch (wal_t *w, const int *src, const int *dst, size_t n, int flags)
+{
+  if (!w)
+    return;
+
+  unsigned char *p;
+
+  pthread_mutex_lock(&(w->lock));
+
+  if (!(p = start_record(w, WAL_BATCH, 1 + 5 + 10 + 10 * n)))
+  {
+    pthread_mutex_unlock(&(w->lock));
+    return;
+  }
+
+  p = put_varint(put_int(p, flags), n);
+  for (size_t i = 0; i < n; ++i)
+    p = put_int(put_int(p, src[i]), dst[i]);
+
+  end_record(w, p);
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void wal_fail (wal_t *w)
+{
+  if (!w)
+    return;
+
+  pthread_mutex_lock(&(w->lock));
+  w->error = 1;
+  pthread_mutex_unlock(&(w->lock));
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int wal_sync (wal_t *w)
+{
+  if (!w)
+    return 0;
+
+  int ok;
+
+  pthread_mutex_lock(&(w->lock));
+  sync_unlock(w);
+
+  pthread_mutex_lock(&(w->lock));
+  ok = !w->error;
+  pthread_mutex_unlock(&(w->lock));
+
+  return ok;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int wal_compact (wal_t *w, graph_t *g)
+{
+  if (!w || !g)
+    return 0;
+
+  char *tmp = (char *) calloc(strlen(w->path) + 9, sizeof(char));
+  int fd = -1, old, error;
+  size_t bytes;
+  wal_header_t h;
+
+  if (!tmp)
+    return 0;
+
+  sprintf(tmp, "%s.compact", w->path);
+
+  if ((fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644)) < 0)
+  {
+    free(tmp);
+    return 0;
+  }
+
+  init_header(&h);
+  pthread_mutex_lock(&(w->lock));
+
+  // the old log stays complete until the new one replaces it
+  flush_frame(w);
+  old = w->fd;
+  bytes = w->bytes;
+  error = w->error;
+
+  w->fd = fd;
+  w->bytes = sizeof(wal_header_t);
+  w->pending = 0;
+  w->error = !write_all(fd, &h, sizeof(wal_header_t));
+
+  if (!w->error)
+    write_graph_records(w, g);
+
+  if (w->error || fsync(fd) < 0 || rename(tmp, w->path) < 0)
+  {
+    close(fd);
+    unlink(tmp);
+    w->fd = old;
+    w->bytes = bytes;
+    w->error = error;
+    pthread_mutex_unlock(&(w->lock));
+    free(tmp);
+    return 0;
+  }
+
+  sync_directory(w->path);
+  close(old);
+  w->base = w->bytes;
+  w->error = error;
+  pthread_mutex_unlock(&(w->lock));
+
+  free(tmp);
+  return 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int wal_checkpoint (wal_t *w, graph_t *g)
+{
+  if (!wal_sync(w))
+    return 0;
+
+  int grown;
+
+  // the appends of other threads may still change the size
+  pthread_mutex_lock(&(w->lock));
+  grown = w->bytes > WAL_COMPACT_MIN && w->bytes > 2 * w->base;
+  pthread_mutex_unlock(&(w->lock));
+
+  return grown ? wal_compact(w, g) : 1;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int wal_close (wal_t *w)
+{
+  if (!w)
+    return 0;
+
+  int ok = wal_sync(w);
+
+  if (close(w->fd) < 0)
+    ok = 0;
+
+  pthread_mutex_destroy(&(w->lock));
+  free(w->buffer);
+  free(w->path);
+  free(w);
+  return ok;
+}
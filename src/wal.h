@@ -0,0 +1,231 @@
+#ifndef __WAL__
+#define __WAL__
+
+/* ------------------------------------------------------------------------------ */
+
+#include "graph.h"
+
+/* ------------------------------------------------------------------------------
+ * log records
+ * ------------------------------------------------------------------------------
+ * every record is an operation byte followed by its fields, the integers as
+ * zigzag varints (7 bits per byte) and the weights as 8 raw bytes
+ *
+ * WAL_ADD_VERTEX: id, value (every vertex inserted, by any function)
+ * WAL_ADD_EDGE: source id, destination id (add_edge, weight 1)
+ * WAL_ADD_WEIGHTED_EDGE: source id, destination id, weight
+ * WAL_REMOVE_EDGE: source id, destination id
+ * WAL_REMOVE_VERTEX: id, is_directed
+ * WAL_ADD_EDGES: source id, count, destination ids (each one as its distance
+ * to the previous id), written by wal_compact
+ * WAL_BATCH: batch flags, count, (source id, destination id) pairs
+ * (graph_add_edges)
+ * ------------------------------------------------------------------------------ */
+
+#define WAL_ADD_VERTEX 1
+#define WAL_ADD_EDGE 2
+#define WAL_ADD_WEIGHTED_EDGE 3
+#define WAL_REMOVE_EDGE 4
+#define WAL_REMOVE_VERTEX 5
+#define WAL_ADD_EDGES 6
+#define WAL_BATCH 7
+
+/* ------------------------------------------------------------------------------ */
+
+#define WAL_BUFFER_SIZE (1 << 16)
+#define WAL_RUN 1024
+#define WAL_COMPACT_MIN (1 << 20)
+
+/* ------------------------------------------------------------------------------
+ * structure: wal (write-ahead log)
+ * ------------------------------------------------------------------------------
+ * append only log of the changes of a graph (see wal_attach). The file starts
+ * with a header and is followed by frames: the size of the frame, a checksum
+ * and the records buffered until then. A frame cut by a crash fails its
+ * checksum, so replay stops at the last complete one.
+ *
+ * Checkpoints cost as much as the records written since the last one:
+ * wal_sync writes them and calls fsync once for all of them. wal_compact
+ * rewrites the whole log as the records of the current graph, which takes
+ * O(V + E), so wal_checkpoint only does it after the log has doubled.
+ *
+ * lock: serializes the appends of concurrent writers
+ * fd: log file, opened for appending
+ * path: path of the log file
+ * buffer: records that were not written yet
+ * used: number of bytes used in buffer
+ * capacity: number of bytes in buffer (grows for records larger than it)
+ * pending: number of records since the last fsync
+ * sync_every: number of records that triggers an fsync (0 if only wal_sync
+ * does it)
+ * bytes: size of the log file (without the buffered records)
+ * base: size of the log file when it was opened or compacted
+ * error: indicates if a write or an fsync has failed (1) or not (0)
+ * ------------------------------------------------------------------------------ */
+
+struct wal_t
+{
+  pthread_mutex_t lock ;
+  int fd ;
+  char *path ;
+  unsigned char *buffer ;
+  size_t used ;
+  size_t capacity ;
+  int pending ;
+  int sync_every ;
+  size_t bytes ;
+  size_t base ;
+  int error ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_replay
+ * ------------------------------------------------------------------------------
+ * applies the records of a log to a graph (usually an empty one, before the
+ * log is opened). The records after the last complete frame are ignored, and
+ * so are the removals of edges that are not in the graph. The graph gets the
+ * same vertices (at the same indices), values and edges, but the order of the
+ * edges lists may change after a wal_compact.
+ *
+ * path: path of the log file
+ * g: graph that receives the changes
+ *
+ * returns: number of records applied (0 if the file does not exist) or -1 if
+ * an error has ocurred
+ * ------------------------------------------------------------------------------ */
+
+long wal_replay (const char *path, graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_open
+ * ------------------------------------------------------------------------------
+ * opens (or creates) a log for appending. An incomplete frame at the end of
+ * the file, left by a crash, is cut off.
+ *
+ * path: path of the log file
+ * sync_every: number of records that triggers an fsync, inside the change
+ * that writes the last of them (0 if only wal_sync does it)
+ *
+ * returns: pointer to the log or NULL if an error has ocurred (or the file
+ * is not a log)
+ * ------------------------------------------------------------------------------ */
+
+wal_t *wal_open (const char *path, int sync_every) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_attach
+ * ------------------------------------------------------------------------------
+ * makes a graph write its changes to a log (or stop, if w is NULL). It must
+ * be called before other threads use the graph.
+ *
+ * w: log that receives the changes
+ * g: graph to be logged
+ * ------------------------------------------------------------------------------ */
+
+void wal_attach (wal_t *w, graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_append
+ * ------------------------------------------------------------------------------
+ * buffers a record of a single change (used by graph.c). It can be called
+ * from any thread.
+ *
+ * w: log that receives the record
+ * op: WAL_ADD_VERTEX, WAL_ADD_EDGE, WAL_ADD_WEIGHTED_EDGE, WAL_REMOVE_EDGE or
+ * WAL_REMOVE_VERTEX
+ * a: first field of the record
+ * b: second field of the record
+ * weight: weight of WAL_ADD_WEIGHTED_EDGE (ignored by the others)
+ * ------------------------------------------------------------------------------ */
+
+void wal_append (wal_t *w, int op, int a, int b, double weight) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_append_batch
+ * ------------------------------------------------------------------------------
+ * buffers a WAL_BATCH record (used by graph_add_edges). It can be called from
+ * any thread.
+ *
+ * w: log that receives the record
+ * src: source vertex id of each edge
+ * dst: destination vertex id of each edge
+ * n: number of edges
+ * flags: bitwise or of the BATCH_* flags
+ * ------------------------------------------------------------------------------ */
+
+void wal_append_batch (wal_t *w, const int *src, const int *dst, size_t n, int flags) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_fail
+ * ------------------------------------------------------------------------------
+ * marks a log as failed, so wal_sync, wal_checkpoint and wal_close report it
+ * (used by graph.c when a change could not be logged). It can be called from
+ * any thread.
+ *
+ * w: log that failed
+ * ------------------------------------------------------------------------------ */
+
+void wal_fail (wal_t *w) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_sync
+ * ------------------------------------------------------------------------------
+ * writes the buffered records and waits until they are on disk (fsync). The
+ * appends of other threads only wait for the write, not for the fsync.
+ *
+ * w: log to be synced
+ *
+ * returns: 0 if an error has ocurred (now or since the log was opened) or 1
+ * if no errors
+ * ------------------------------------------------------------------------------ */
+
+int wal_sync (wal_t *w) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_compact
+ * ------------------------------------------------------------------------------
+ * replaces the log with the records of the current graph (every vertex, in
+ * index order, then the edges lists), written to a new file that takes the
+ * place of the old one at once, so a crash leaves either of them. No other
+ * thread can change the graph meanwhile.
+ *
+ * w: log to be compacted
+ * g: graph logged in w
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int wal_compact (wal_t *w, graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_checkpoint
+ * ------------------------------------------------------------------------------
+ * syncs the log and compacts it when it is over WAL_COMPACT_MIN bytes and
+ * twice the size it had after it was opened or compacted, so the cost of
+ * compaction is spread over the changes that caused it. Not thread safe, like
+ * wal_compact.
+ *
+ * w: log to be checkpointed
+ * g: graph logged in w
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int wal_checkpoint (wal_t *w, graph_t *g) ;
+
+/* ------------------------------------------------------------------------------
+ * function: wal_close
+ * ------------------------------------------------------------------------------
+ * syncs and closes a log. It must be detached from its graph first.
+ *
+ * w: log to be closed
+ *
+ * returns: 0 if an error has ocurred (now or since the log was opened) or 1
+ * if no errors
+ * ------------------------------------------------------------------------------ */
+
+int wal_close (wal_t *w) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,105 @@
+#include <string.h>
+
+#include "trace.h"
+#include "writer.h"
+
+/* ------------------------------------------------------------------------------ */
+
+static void writer_flush (writer_t *w)
+{
+  if (w->used && fwrite(w->buffer, 1, w->used, w->output) != w->used)
+    w->error = 1;
+
+  TRACE_COUNT(TRACE_BYTES, w->used);
+
+  w->used = 0;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int writer_init (writer_t *w, FILE *output)
+{
+  if (!w || !output)
+    return 0;
+
+  w->output = output;
+  w->used = 0;
+  w->error = 0;
+
+  return (w->buffer = (char *) malloc(WRITER_BUFFER_SIZE)) != NULL;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void writer_bytes (writer_t *w, const void *data, size_t size)
+{
+  if (w->used + size > WRITER_BUFFER_SIZE)
+    writer_flush(w);
+
+  if (size > WRITER_BUFFER_SIZE) // too big to be buffered
+  {
+    if (fwrite(data, 1, size, w->output) != size)
+      w->error = 1;
+    TRACE_COUNT(TRACE_BYTES, size);
+    return;
+  }
+
+  memcpy(w->buffer + w->used, data, size);
+  w->used += size;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void writer_int (writer_t *w, int value, char sep)
+{
+  char digits[12];
+  unsigned int u = value < 0 ? 0u - (unsigned int) value : (unsigned int) value;
+  int n = 0;
+
+  if (w->used + sizeof(digits) + 1 > WRITER_BUFFER_SIZE)
+    writer_flush(w);
+
+  do // digits in reverse order
+    digits[n++] = '0' + u % 10;
+  while ((u /= 10));
+
+  if (value < 0)
+    w->buffer[w->used++] = '-';
+
+  while (n)
+    w->buffer[w->used++] = digits[--n];
+
+  w->buffer[w->used++] = sep;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+void writer_double (writer_t *w, double value, char sep)
+{
+  char digits[32];
+  int n = snprintf(digits, sizeof(digits), "%.15g", value);
+
+  if (strtod(digits, NULL) != value) // 15 digits are not enough
+    n = snprintf(digits, sizeof(digits), "%.17g", value);
+
+  if (w->used + n + 1 > WRITER_BUFFER_SIZE)
+    writer_flush(w);
+
+  memcpy(w->buffer + w->used, digits, n);
+  w->used += n;
+  w->buffer[w->used++] = sep;
+}
+
+/* ------------------------------------------------------------------------------ */
+
+int writer_close (writer_t *w)
+{
+  if (!w)
+    return 0;
+
+  writer_flush(w);
+  free(w->buffer);
+  w->buffer = NULL;
+
+  return !w->error;
+}
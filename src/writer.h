@@ -0,0 +1,102 @@
+#ifndef __WRITER__
+#define __WRITER__
+
+/* ------------------------------------------------------------------------------ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* ------------------------------------------------------------------------------ */
+
+#define WRITER_BUFFER_SIZE (1 << 20)
+
+/* ------------------------------------------------------------------------------ */
+
+typedef struct writer_t writer_t ;
+
+/* ------------------------------------------------------------------------------
+ * structure: writer
+ * ------------------------------------------------------------------------------
+ * buffered output, the buffer is only written to the output when it is full
+ * or when the writer is flushed
+ *
+ * output: output in which the data will be written
+ * buffer: user space buffer (WRITER_BUFFER_SIZE bytes)
+ * used: number of bytes used in the buffer
+ * error: indicates if a write to the output has failed (1) or not (0)
+ * ------------------------------------------------------------------------------ */
+
+struct writer_t
+{
+  FILE *output ;
+  char *buffer ;
+  size_t used ;
+  int error ;
+} ;
+
+/* ------------------------------------------------------------------------------
+ * function: writer_init
+ * ------------------------------------------------------------------------------
+ * initializes a writer
+ *
+ * w: writer to be initialized
+ * output: output in which the data will be written
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int writer_init (writer_t *w, FILE *output) ;
+
+/* ------------------------------------------------------------------------------
+ * function: writer_bytes
+ * ------------------------------------------------------------------------------
+ * writes raw bytes
+ *
+ * w: writer in which the bytes will be written
+ * data: bytes to be written
+ * size: number of bytes
+ * ------------------------------------------------------------------------------ */
+
+void writer_bytes (writer_t *w, const void *data, size_t size) ;
+
+/* ------------------------------------------------------------------------------
+ * function: writer_int
+ * ------------------------------------------------------------------------------
+ * writes an integer in decimal followed by a separator
+ *
+ * w: writer in which the integer will be written
+ * value: integer to be written
+ * sep: character written after the integer
+ * ------------------------------------------------------------------------------ */
+
+void writer_int (writer_t *w, int value, char sep) ;
+
+/* ------------------------------------------------------------------------------
+ * function: writer_double
+ * ------------------------------------------------------------------------------
+ * writes a decimal number with the shortest of 15 or 17 significant digits
+ * that reads back to the same value, followed by a separator
+ *
+ * w: writer in which the number will be written
+ * value: number to be written
+ * sep: character written after the number
+ * ------------------------------------------------------------------------------ */
+
+void writer_double (writer_t *w, double value, char sep) ;
+
+/* ------------------------------------------------------------------------------
+ * function: writer_close
+ * ------------------------------------------------------------------------------
+ * flushes the buffer to the output and deallocate it (the output is not
+ * closed)
+ *
+ * w: writer to be closed
+ *
+ * returns: 0 if an error has ocurred or 1 if no errors
+ * ------------------------------------------------------------------------------ */
+
+int writer_close (writer_t *w) ;
+
+/* ------------------------------------------------------------------------------ */
+
+#endif